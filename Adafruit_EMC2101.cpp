@@ -33,11 +33,74 @@
  *     v1.0 - First release
  */
 
-#include "Arduino.h"
-#include <Wire.h>
-
 #include "Adafruit_EMC2101.h"
 
+/**
+ * @brief The registers saved by `saveConfig`, in the order they are restored.
+ * The fan config register, which holds the LUT enable, must stay last and the
+ * LUT entries must follow the fan setting
+ */
+const uint8_t Adafruit_EMC2101::_config_regs[EMC2101_CONFIG_REG_COUNT] = {
+    EMC2101_REG_CONFIG,
+    EMC2101_REG_DATA_RATE,
+    EMC2101_INT_TEMP_HIGH_LIMIT,
+    EMC2101_EXT_TEMP_HIGH_LIMIT_MSB,
+    EMC2101_EXT_TEMP_LOW_LIMIT_MSB,
+    EMC2101_TEMP_FORCE,
+    EMC2101_EXT_TEMP_HIGH_LIMIT_LSB,
+    EMC2101_EXT_TEMP_LOW_LIMIT_LSB,
+    EMC2101_ALERT_MASK,
+    EMC2101_TCRIT_LIMIT,
+    EMC2101_TCRIT_HYSTERESIS,
+    EMC2101_TACH_LIMIT_LSB,
+    EMC2101_TACH_LIMIT_MSB,
+    EMC2101_FAN_SPINUP,
+    EMC2101_PWM_FREQ,
+    EMC2101_PWM_DIV,
+    EMC2101_LUT_HYSTERESIS,
+    EMC2101_EXT_IDEALITY,
+    EMC2101_EXT_BETA_COMP,
+    EMC2101_TEMP_FILTER,
+    EMC2101_REG_FAN_SETTING,
+    EMC2101_LUT_START,
+    EMC2101_LUT_START + 1,
+    EMC2101_LUT_START + 2,
+    EMC2101_LUT_START + 3,
+    EMC2101_LUT_START + 4,
+    EMC2101_LUT_START + 5,
+    EMC2101_LUT_START + 6,
+    EMC2101_LUT_START + 7,
+    EMC2101_LUT_START + 8,
+    EMC2101_LUT_START + 9,
+    EMC2101_LUT_START + 10,
+    EMC2101_LUT_START + 11,
+    EMC2101_LUT_START + 12,
+    EMC2101_LUT_START + 13,
+    EMC2101_LUT_START + 14,
+    EMC2101_LUT_START + 15,
+    EMC2101_FAN_CONFIG};
+
+/**
+ * @brief The registers read for a snapshot, in order. The external temperature
+ * is read **MSB** first and the tach LSB first to match the 'Data Read
+ * Interlock' behavoior from 6.1 of the datasheet
+ */
+const uint8_t Adafruit_EMC2101::_snapshot_regs[EMC2101_SNAPSHOT_STEPS] = {
+    EMC2101_INTERNAL_TEMP,     EMC2101_EXTERNAL_TEMP_MSB,
+    EMC2101_EXTERNAL_TEMP_LSB, EMC2101_STATUS,
+    EMC2101_TACH_LSB,          EMC2101_TACH_MSB,
+    EMC2101_REG_FAN_SETTING};
+
+/**
+ * @brief The registers a configuration transaction can stage, in the order
+ * `commitConfig` writes them. The PWM clock settings go before the fan config
+ * register that selects them, and the fan config register, which holds the
+ * LUT enable, goes last
+ */
+const uint8_t Adafruit_EMC2101::_txn_regs[EMC2101_TXN_REGS] = {
+    EMC2101_PWM_DIV, EMC2101_PWM_FREQ, EMC2101_FAN_SPINUP, EMC2101_REG_CONFIG,
+    EMC2101_FAN_CONFIG};
+
 /**
  * @brief Construct a new Adafruit_EMC2101::Adafruit_EMC2101 object
  *
@@ -48,7 +111,15 @@ Adafruit_EMC2101::Adafruit_EMC2101(void) {}
  * @brief Destroy the Adafruit_EMC2101::Adafruit_EMC2101 object
  *
  */
-Adafruit_EMC2101::~Adafruit_EMC2101(void) {}
+Adafruit_EMC2101::~Adafruit_EMC2101(void) {
+#if !defined(EMC2101_LINUX_HOST)
+  if (_owns_i2c_dev) {
+    delete i2c_dev;
+  }
+#endif
+}
+
+#if !defined(EMC2101_LINUX_HOST)
 
 /*!
  *    @brief  Sets up the hardware and initializes I2C
@@ -56,47 +127,159 @@ Adafruit_EMC2101::~Adafruit_EMC2101(void) {}
  *            The I2C address to be used.
  *    @param  wire
  *            The Wire object to be used for I2C connections.
+ *    @param  config
+ *            Optional configuration saved with `saveConfig`. When given and
+ *            valid, only the registers that differ from it are written
+ *            instead of applying the default settings
+ *    @return True if initialization was successful, otherwise false.
+ */
+bool Adafruit_EMC2101::begin(uint8_t i2c_address, TwoWire *wire,
+                             const uint8_t *config) {
+  EMC2101_INSTRUMENT("begin(addr)");
+  // reuse the interface we made last time, so re-begins after a bus
+  // recovery don't churn the heap
+  if (!_owns_i2c_dev || (_wire != wire) ||
+      (i2c_dev->address() != i2c_address)) {
+    if (_owns_i2c_dev) {
+      delete i2c_dev; // remove old interface
+    }
+    i2c_dev = new Adafruit_I2CDevice(i2c_address, wire);
+    _owns_i2c_dev = true;
+    _wire = wire;
+  }
+
+  return _beginBusIO(config);
+}
+
+/*!
+ *    @brief  Sets up the hardware using an I2C interface owned by the caller,
+ *            without any heap allocation. The interface can be a global or
+ *            static object, and must outlive this one:
+ *    @code
+ *    Adafruit_I2CDevice emc2101_i2c(EMC2101_I2CADDR_DEFAULT, &Wire);
+ *    Adafruit_EMC2101 emc2101;
+ *    // in setup():
+ *    emc2101.begin(&emc2101_i2c);
+ *    @endcode
+ *    @param  i2c_device
+ *            The I2C interface to use
+ *    @param  config
+ *            Optional configuration saved with `saveConfig`, as for
+ *            `begin(uint8_t, TwoWire *, const uint8_t *)`
  *    @return True if initialization was successful, otherwise false.
  */
-bool Adafruit_EMC2101::begin(uint8_t i2c_address, TwoWire *wire) {
-  if (i2c_dev) {
+bool Adafruit_EMC2101::begin(Adafruit_I2CDevice *i2c_device,
+                             const uint8_t *config) {
+  EMC2101_INSTRUMENT("begin(device)");
+  if (!i2c_device) {
+    return false;
+  }
+  if (_owns_i2c_dev) {
     delete i2c_dev; // remove old interface
+    _owns_i2c_dev = false;
   }
+  i2c_dev = i2c_device;
+  _wire = NULL;
 
-  i2c_dev = new Adafruit_I2CDevice(i2c_address, wire);
+  return _beginBusIO(config);
+}
 
+/*!  @brief Start `i2c_dev` and use it as the transport
+ *   @param config Optional saved configuration, passed to `_init`
+ *   @returns True if the chip was found and initialized
+ */
+bool Adafruit_EMC2101::_beginBusIO(const uint8_t *config) {
   if (!i2c_dev->begin()) {
     Serial.println("Address not found");
     return false;
   }
 
-  return _init();
+  _busio.setDevice(i2c_dev);
+  _transport = &_busio;
+  return _init(config);
+}
+#endif
+
+/*!
+ *    @brief  Sets up the hardware using a transport owned by the caller, such
+ *            as `Adafruit_EMC2101_LinuxI2C` on a Linux host or a custom one
+ *            for another bus API:
+ *    @code
+ *    Adafruit_EMC2101_LinuxI2C bus;
+ *    Adafruit_EMC2101 emc2101;
+ *    if (bus.begin("/dev/i2c-1") && emc2101.begin(&bus)) {
+ *      // ready
+ *    }
+ *    @endcode
+ *    @param  transport
+ *            The transport to use, which must outlive this object
+ *    @param  config
+ *            Optional configuration saved with `saveConfig`
+ *    @return True if initialization was successful, otherwise false.
+ */
+bool Adafruit_EMC2101::begin(Adafruit_EMC2101_Transport *transport,
+                             const uint8_t *config) {
+  EMC2101_INSTRUMENT("begin(transport)");
+  if (!transport) {
+    return false;
+  }
+#if !defined(EMC2101_LINUX_HOST)
+  if (_owns_i2c_dev) {
+    delete i2c_dev; // remove old interface
+    _owns_i2c_dev = false;
+  }
+  i2c_dev = NULL;
+  _wire = NULL;
+#endif
+  _transport = transport;
+  return _init(config);
 }
 
 /*!  @brief Initializer for post i2c/spi init
+ *   @param config Optional saved configuration to restore instead of applying
+ *   the defaults. An invalid configuration is ignored
  *   @returns True if chip identified and initialized
  */
-bool Adafruit_EMC2101::_init(void) {
+bool Adafruit_EMC2101::_init(const uint8_t *config) {
+  BusGuard guard(this);
+  // the chip may have been reset since the last begin
+  _lut_known_disabled = false;
+  _last_duty_raw = EMC2101_DUTY_UNKNOWN;
+  _pending_status = 0;
 
-  Adafruit_BusIO_Register chip_id =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_WHOAMI, 1);
+  uint8_t chip_id = _readReg(EMC2101_WHOAMI);
 
   // make sure we're talking to the right chip
-  if ((chip_id.read() != EMC2101_CHIP_ID) &&
-      (chip_id.read() != EMC2101_ALT_CHIP_ID)) {
+  if ((chip_id != EMC2101_CHIP_ID) && (chip_id != EMC2101_ALT_CHIP_ID)) {
+#if !defined(EMC2101_LINUX_HOST)
     Serial.println("Wrong chip ID ");
+#endif
+    return false;
+  }
+
+  if (config && configValid(config)) {
+    return restoreConfig(config);
+  }
+
+  if (_cache_enabled && !resync()) {
     return false;
   }
 
+  // one write to each of the configuration registers that need changing
+  beginConfig();
   enableTachInput(true);
   invertFanSpeed(false);
   setPWMFrequency(0x1F);
   configPWMClock(1, 0);
   DACOutEnabled(false); // output PWM mode by default
   LUTEnabled(false);
-  setDutyCycle(100);
-
   enableForcedTemperature(false);
+  if (!commitConfig()) {
+    return false;
+  }
+
+  // after the commit, which disables the LUT
+  setDutyCycle(100);
 
   // Set to highest rate
   setDataRate(EMC2101_RATE_32_HZ);
@@ -104,6 +287,378 @@ bool Adafruit_EMC2101::_init(void) {
   return true;
 }
 
+/**
+ * @brief Save the chip's configuration into a versioned, CRC protected blob
+ * that can be stored in EEPROM and passed to `begin` or `restoreConfig`
+ *
+ * @param config Buffer of `EMC2101_CONFIG_SIZE` bytes to fill
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::saveConfig(uint8_t *config) {
+  EMC2101_INSTRUMENT("saveConfig");
+  BusGuard guard(this);
+  if (!config) {
+    return false;
+  }
+  config[0] = EMC2101_CONFIG_VERSION;
+  for (uint8_t i = 0; i < EMC2101_CONFIG_REG_COUNT; i++) {
+    if (!_read8(_config_regs[i], config + 1 + i)) {
+      return false;
+    }
+  }
+  config[EMC2101_CONFIG_SIZE - 1] = _crc8(config, EMC2101_CONFIG_SIZE - 1);
+  return true;
+}
+
+/**
+ * @brief Check that a saved configuration blob is intact and of the version
+ * this driver writes
+ *
+ * @param config The blob, `EMC2101_CONFIG_SIZE` bytes
+ * @return true: the blob can be restored false: the blob is invalid
+ */
+bool Adafruit_EMC2101::configValid(const uint8_t *config) {
+  return config && (config[0] == EMC2101_CONFIG_VERSION) &&
+         (_crc8(config, EMC2101_CONFIG_SIZE - 1) ==
+          config[EMC2101_CONFIG_SIZE - 1]);
+}
+
+/**
+ * @brief Restore a configuration saved with `saveConfig`, writing only the
+ * registers whose contents differ from the blob.
+ *
+ * The LUT is disabled while any LUT entry or the fan setting is changed, and
+ * the fan config register, which holds the LUT enable, is written last.
+ *
+ * @param config The blob, `EMC2101_CONFIG_SIZE` bytes
+ * @return true: success false: invalid blob or bus failure
+ */
+bool Adafruit_EMC2101::restoreConfig(const uint8_t *config) {
+  EMC2101_INSTRUMENT("restoreConfig");
+  BusGuard guard(this);
+  if (!configValid(config)) {
+    return false;
+  }
+  const uint8_t *values = config + 1;
+
+  uint8_t fan_config, target_fan_config = 0;
+  if (!_read8(EMC2101_FAN_CONFIG, &fan_config)) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < EMC2101_CONFIG_REG_COUNT; i++) {
+    uint8_t reg_addr = _config_regs[i];
+    if (reg_addr == EMC2101_FAN_CONFIG) {
+      target_fan_config = values[i];
+      continue;
+    }
+    uint8_t current;
+    if (!_read8(reg_addr, &current)) {
+      return false;
+    }
+    if (current == values[i]) {
+      continue;
+    }
+
+    bool needs_lut_off = (reg_addr == EMC2101_REG_FAN_SETTING) ||
+                         (reg_addr >= EMC2101_LUT_START);
+    if (needs_lut_off && !(fan_config & EMC2101_LUT_DISABLE_FIELD.mask)) {
+      fan_config |= EMC2101_LUT_DISABLE_FIELD.mask;
+      if (!_write8(EMC2101_FAN_CONFIG, fan_config)) {
+        return false;
+      }
+    }
+    if (!_write8(reg_addr, values[i])) {
+      return false;
+    }
+    if (reg_addr == EMC2101_REG_DATA_RATE) {
+      _dataRateChanged((emc2101_rate_t)(values[i] & 0xF));
+    }
+  }
+
+  if ((fan_config != target_fan_config) &&
+      !_write8(EMC2101_FAN_CONFIG, target_fan_config)) {
+    return false;
+  }
+
+  _lut_known_disabled = EMC2101_LUT_DISABLE_FIELD.get(target_fan_config);
+  _last_duty_raw = EMC2101_DUTY_UNKNOWN;
+  return !_cache_enabled || resync();
+}
+
+/**
+ * @brief Compute the CRC-8 (polynomial 0x31) used to protect saved
+ * configurations
+ *
+ * @param data The bytes to check
+ * @param len The number of bytes
+ * @return uint8_t The CRC
+ */
+uint8_t Adafruit_EMC2101::_crc8(const uint8_t *data, uint8_t len) {
+  uint8_t crc = 0xFF;
+  for (uint8_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief Enable or disable the write-through shadow cache of the FAN_CONFIG,
+ * REG_CONFIG and FAN_SPINUP registers.
+ *
+ * While enabled, bit-level setters write the full register from the cached
+ * copy in a single transaction instead of reading it back first, and getters
+ * such as `LUTEnabled()` and `DACOutEnabled()` are served from RAM. Call
+ * `resync()` if anything other than this driver may have modified the chip.
+ *
+ * @param enable_cache true to enable the cache, false to always go to the bus
+ * @return true: success false: the cache could not be filled from the chip
+ */
+bool Adafruit_EMC2101::enableRegisterCache(bool enable_cache) {
+  EMC2101_INSTRUMENT("enableRegisterCache");
+  BusGuard guard(this);
+  _cache_enabled = enable_cache;
+  if (!_cache_enabled || !_transport) {
+    return true; // will be filled by `_init()`
+  }
+  return resync();
+}
+
+/**
+ * @brief Re-read the cached configuration registers from the chip. This also
+ * refreshes whether the driver knows the LUT to be disabled, which is used by
+ * `setDutyCycleRaw`
+ *
+ * @return true: success false: failure. On failure the cache is disabled so
+ * that stale values are never used
+ */
+bool Adafruit_EMC2101::resync(void) {
+  EMC2101_INSTRUMENT("resync");
+  BusGuard guard(this);
+  if (!_read8(EMC2101_FAN_CONFIG, &_fan_config_shadow) ||
+      !_read8(EMC2101_REG_CONFIG, &_reg_config_shadow) ||
+      !_read8(EMC2101_FAN_SPINUP, &_fan_spinup_shadow)) {
+    _cache_enabled = false;
+    _lut_known_disabled = false;
+    return false;
+  }
+  _lut_known_disabled = EMC2101_LUT_DISABLE_FIELD.get(_fan_config_shadow);
+  _last_duty_raw = EMC2101_DUTY_UNKNOWN;
+  return true;
+}
+
+/**
+ * @brief Get the shadow copy of a cached register
+ *
+ * @param reg_addr The register address
+ * @return uint8_t* Pointer to the shadow value, or NULL if the register is not
+ * cached or the cache is disabled
+ */
+uint8_t *Adafruit_EMC2101::_shadowFor(uint8_t reg_addr) {
+  if (!_cache_enabled) {
+    return NULL;
+  }
+  switch (reg_addr) {
+  case EMC2101_FAN_CONFIG:
+    return &_fan_config_shadow;
+  case EMC2101_REG_CONFIG:
+    return &_reg_config_shadow;
+  case EMC2101_FAN_SPINUP:
+    return &_fan_spinup_shadow;
+  default:
+    return NULL;
+  }
+}
+
+/**
+ * @brief Read a register, using the shadow cache if possible. Bits staged by
+ * an open configuration transaction are returned in place of the chip's
+ *
+ * @param reg_addr The register address
+ * @param value Where to store the register value. Unchanged on failure
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::_readCached(uint8_t reg_addr, uint8_t *value) {
+  int8_t txn = _txnIndex(reg_addr);
+  uint8_t staged_mask = (txn < 0) ? 0 : _txn_mask[txn];
+  uint8_t *shadow = _shadowFor(reg_addr);
+  uint8_t reg_value = 0;
+  if (shadow) {
+    reg_value = *shadow;
+  } else if ((staged_mask != 0xFF) && !_read8(reg_addr, &reg_value)) {
+    return false;
+  }
+  if (staged_mask) {
+    reg_value = (reg_value & ~staged_mask) | _txn_bits[txn];
+  }
+  *value = reg_value;
+  return true;
+}
+
+/**
+ * @brief Replace some of a register's bits. Cached registers are updated with
+ * a single write, others with a read-modify-write, or a plain write when every
+ * bit is replaced. Used by the field helpers, which work out `mask` and `bits`
+ * at compile time.
+ *
+ * While a configuration transaction is open, changes to the registers it
+ * covers are only staged, to be written by `commitConfig`.
+ *
+ * @param reg_addr The register address
+ * @param mask The bits to replace
+ * @param bits The new values of the masked bits, already in position
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::_updateReg(uint8_t reg_addr, uint8_t mask,
+                                  uint8_t bits) {
+  int8_t txn = _txnIndex(reg_addr);
+  if (txn >= 0) {
+    _txn_mask[txn] |= mask;
+    _txn_bits[txn] = (_txn_bits[txn] & ~mask) | (bits & mask);
+    return true;
+  }
+
+  BusGuard guard(this);
+  uint8_t *shadow = _shadowFor(reg_addr);
+  uint8_t old_value = 0;
+  if (shadow) {
+    old_value = *shadow;
+  } else if ((mask != 0xFF) && !_read8(reg_addr, &old_value)) {
+    return false;
+  }
+
+  uint8_t new_value = (old_value & ~mask) | (bits & mask);
+  if (!_write8(reg_addr, new_value)) {
+    return false;
+  }
+  if (shadow) {
+    *shadow = new_value;
+  }
+  return true;
+}
+
+/**
+ * @brief Find where a register is staged by the open configuration
+ * transaction
+ *
+ * @param reg_addr The register address
+ * @return int8_t The register's index in `_txn_regs`, or -1 if no transaction
+ * is open or the register isn't one it covers
+ */
+int8_t Adafruit_EMC2101::_txnIndex(uint8_t reg_addr) {
+  if (!_txn_open) {
+    return -1;
+  }
+  for (uint8_t i = 0; i < EMC2101_TXN_REGS; i++) {
+    if (_txn_regs[i] == reg_addr) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Start collecting configuration changes instead of writing them.
+ *
+ * Until `commitConfig()` or `cancelConfig()`, the settings held in the
+ * FAN_CONFIG, REG_CONFIG, FAN_SPINUP, PWM_FREQ and PWM_DIV registers are only
+ * staged. That covers `enableTachInput`, `invertFanSpeed`, `configPWMClock`,
+ * `configFanSpinup`, `LUTEnabled(bool)`, `DACOutEnabled(bool)`,
+ * `enableForcedTemperature`, `setPWMFrequency` and `setPWMDivisor`. Getters of
+ * those settings return the staged values. Other setters still write
+ * immediately, except that `setDutyCycle`, `setDutyCycleRaw`, `setLUT` and
+ * `swapLUT` fail while a transaction is open: the chip ignores those writes
+ * while the LUT is enabled, and a staged `LUTEnabled(false)` hasn't taken
+ * effect yet. Set them after committing.
+ *
+ * @code
+ * emc2101.beginConfig();
+ * emc2101.invertFanSpeed(false);
+ * emc2101.configPWMClock(1, 0);
+ * emc2101.LUTEnabled(false);
+ * emc2101.enableForcedTemperature(false);
+ * emc2101.commitConfig(); // one write to FAN_CONFIG
+ * @endcode
+ */
+void Adafruit_EMC2101::beginConfig(void) {
+  _txn_open = true;
+  memset(_txn_mask, 0, sizeof(_txn_mask));
+  memset(_txn_bits, 0, sizeof(_txn_bits));
+}
+
+/**
+ * @brief Write the changes staged since `beginConfig()`, each register at
+ * most once. Registers are written PWM_DIV, PWM_FREQ, FAN_SPINUP, REG_CONFIG
+ * and then FAN_CONFIG, so the PWM clock is set up before it is selected and
+ * the LUT is enabled last. Registers that would keep their value are skipped.
+ *
+ * The transaction is closed even if a write fails; the registers before the
+ * failed one keep their new values
+ *
+ * @param changed Optional, set to the `EMC2101_TXN_*` bits of the registers
+ * written
+ * @return true: success or nothing to write false: failure
+ */
+bool Adafruit_EMC2101::commitConfig(uint8_t *changed) {
+  EMC2101_INSTRUMENT("commitConfig");
+  BusGuard guard(this);
+  if (changed) {
+    *changed = 0;
+  }
+  if (!_txn_open) {
+    return true;
+  }
+  _txn_open = false;
+
+  for (uint8_t i = 0; i < EMC2101_TXN_REGS; i++) {
+    uint8_t mask = _txn_mask[i];
+    if (!mask) {
+      continue;
+    }
+    uint8_t reg_addr = _txn_regs[i];
+    uint8_t *shadow = _shadowFor(reg_addr);
+    uint8_t old_value = 0;
+    bool known = (shadow != NULL) || (mask != 0xFF);
+    if (shadow) {
+      old_value = *shadow;
+    } else if (known && !_read8(reg_addr, &old_value)) {
+      return false;
+    }
+
+    uint8_t new_value = (old_value & ~mask) | _txn_bits[i];
+    if (!known || (new_value != old_value)) {
+      if (!_write8(reg_addr, new_value)) {
+        return false;
+      }
+      if (shadow) {
+        *shadow = new_value;
+      }
+      if (changed) {
+        *changed |= 1 << i;
+      }
+    }
+    if ((reg_addr == EMC2101_FAN_CONFIG) &&
+        (mask & EMC2101_LUT_DISABLE_FIELD.mask)) {
+      _lut_known_disabled = EMC2101_LUT_DISABLE_FIELD.get(new_value);
+      if (!known || (EMC2101_LUT_DISABLE_FIELD.get(old_value) !=
+                     _lut_known_disabled)) {
+        // the LUT took over the fan setting register, or just handed it back
+        // holding its own last choice
+        _last_duty_raw = EMC2101_DUTY_UNKNOWN;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Discard the changes staged since `beginConfig()`
+ */
+void Adafruit_EMC2101::cancelConfig(void) { _txn_open = false; }
+
 /**
  * @brief Enable using the TACH/ALERT pin as an input to read the fan speed
  * signal from a 4-pin fan
@@ -113,11 +668,8 @@ bool Adafruit_EMC2101::_init(void) {
  * @return true: sucess false: failure
  */
 bool Adafruit_EMC2101::enableTachInput(bool tach_enable) {
-  Adafruit_BusIO_Register reg_config =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_REG_CONFIG);
-  Adafruit_BusIO_RegisterBits tach_mode_enable_bit =
-      Adafruit_BusIO_RegisterBits(&reg_config, 1, 2);
-  return tach_mode_enable_bit.write(tach_enable);
+  EMC2101_INSTRUMENT("enableTachInput");
+  return _writeField(EMC2101_TACH_INPUT_FIELD, tach_enable);
 }
 
 /**
@@ -131,12 +683,8 @@ bool Adafruit_EMC2101::enableTachInput(bool tach_enable) {
  * @return true:sucess false:failure
  */
 bool Adafruit_EMC2101::invertFanSpeed(bool invert_speed) {
-
-  Adafruit_BusIO_Register fan_config =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_FAN_CONFIG);
-  Adafruit_BusIO_RegisterBits invert_fan_output_bit =
-      Adafruit_BusIO_RegisterBits(&fan_config, 1, 4);
-  return invert_fan_output_bit.write(invert_speed);
+  EMC2101_INSTRUMENT("invertFanSpeed");
+  return _writeField(EMC2101_POLARITY_FIELD, invert_speed);
 }
 
 /**
@@ -152,14 +700,10 @@ bool Adafruit_EMC2101::invertFanSpeed(bool invert_speed) {
  * @return true:success false:failure
  */
 bool Adafruit_EMC2101::configPWMClock(bool clksel, bool clkovr) {
-  Adafruit_BusIO_Register fan_config =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_FAN_CONFIG);
-  Adafruit_BusIO_RegisterBits clksel_bit =
-      Adafruit_BusIO_RegisterBits(&fan_config, 1, 3);
-  clksel_bit.write(clksel);
-  Adafruit_BusIO_RegisterBits clkovr_bit =
-      Adafruit_BusIO_RegisterBits(&fan_config, 1, 2);
-  return clkovr_bit.write(clkovr);
+  EMC2101_INSTRUMENT("configPWMClock");
+  // CLK_SEL and CLK_OVR share FAN_CONFIG, so both go in one update
+  return _writeFields(EMC2101_CLK_SEL_FIELD, clksel, EMC2101_CLK_OVR_FIELD,
+                      clkovr);
 }
 
 /**
@@ -176,19 +720,10 @@ bool Adafruit_EMC2101::configPWMClock(bool clksel, bool clkovr) {
  */
 bool Adafruit_EMC2101::configFanSpinup(uint8_t spinup_drive,
                                        uint8_t spinup_time) {
-
-  Adafruit_BusIO_Register spin_config =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_FAN_SPINUP);
-
-  Adafruit_BusIO_RegisterBits _spin_drive_bits =
-      Adafruit_BusIO_RegisterBits(&spin_config, 2, 3);
-  if (!_spin_drive_bits.write(spinup_drive)) {
-    return false;
-  }
-
-  Adafruit_BusIO_RegisterBits _spin_time_bits =
-      Adafruit_BusIO_RegisterBits(&spin_config, 3, 0);
-  return _spin_time_bits.write(spinup_time);
+  EMC2101_INSTRUMENT("configFanSpinup(drive,time)");
+  // drive and time share FAN_SPINUP, so both go in one update
+  return _writeFields(EMC2101_SPINUP_DRIVE_FIELD, spinup_drive,
+                      EMC2101_SPINUP_TIME_FIELD, spinup_time);
 }
 
 /**
@@ -202,12 +737,9 @@ bool Adafruit_EMC2101::configFanSpinup(uint8_t spinup_drive,
  * @return true:success false: failure
  */
 bool Adafruit_EMC2101::configFanSpinup(bool tach_spinup) {
+  EMC2101_INSTRUMENT("configFanSpinup(tach)");
   // This should be settable by the constructor
-  Adafruit_BusIO_Register spin_config =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_FAN_SPINUP);
-  Adafruit_BusIO_RegisterBits tach_spinup_en =
-      Adafruit_BusIO_RegisterBits(&spin_config, 1, 5);
-  return tach_spinup_en.write(tach_spinup);
+  return _writeField(EMC2101_SPINUP_TACH_FIELD, tach_spinup);
 }
 
 /**
@@ -219,10 +751,9 @@ bool Adafruit_EMC2101::configFanSpinup(bool tach_spinup) {
  * @return uint8_t The current LUT hysteresis value
  */
 uint8_t Adafruit_EMC2101::getLUTHysteresis(void) {
+  EMC2101_INSTRUMENT("getLUTHysteresis");
 
-  Adafruit_BusIO_Register lut_temperature_hysteresis =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_LUT_HYSTERESIS);
-  return lut_temperature_hysteresis.read();
+  return _readReg(EMC2101_LUT_HYSTERESIS);
 }
 
 /**
@@ -237,10 +768,9 @@ uint8_t Adafruit_EMC2101::getLUTHysteresis(void) {
  * @return uint8_t The current LUT hysteresis value
  */
 bool Adafruit_EMC2101::setLUTHysteresis(uint8_t hysteresis) {
+  EMC2101_INSTRUMENT("setLUTHysteresis");
 
-  Adafruit_BusIO_Register lut_temperature_hysteresis =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_LUT_HYSTERESIS);
-  return lut_temperature_hysteresis.write(hysteresis);
+  return _write8(EMC2101_LUT_HYSTERESIS, hysteresis);
 }
 
 /**
@@ -271,7 +801,9 @@ bool Adafruit_EMC2101::setLUTHysteresis(uint8_t hysteresis) {
  */
 bool Adafruit_EMC2101::setLUT(uint8_t index, uint8_t temp_thresh,
                               uint8_t fan_pwm) {
-  if (index > 7) {
+  EMC2101_INSTRUMENT("setLUT(index)");
+  BusGuard guard(this);
+  if (_txn_open || (index > 7)) {
     return false;
   }
   if (temp_thresh > MAX_LUT_TEMP) {
@@ -281,212 +813,1133 @@ bool Adafruit_EMC2101::setLUT(uint8_t index, uint8_t temp_thresh,
     return false;
   }
 
-  uint8_t temp_reg_addr = EMC2101_LUT_START + (2 * index); // speed/pwm is +1
-  Adafruit_BusIO_Register lut_temp =
-      Adafruit_BusIO_Register(i2c_dev, temp_reg_addr);
-  Adafruit_BusIO_Register lut_pwm =
-      Adafruit_BusIO_Register(i2c_dev, temp_reg_addr + 1);
-
-  float scalar = (float)fan_pwm / 100.0;
-  uint8_t scaled_pwm = (uint8_t)(scalar * MAX_LUT_SPEED);
-
-  bool lut_enabled = LUTEnabled();
-  LUTEnabled(false);
-  if (!lut_temp.write(temp_thresh)) {
+  // don't touch the table unless we know how to put the LUT back afterwards
+  uint8_t lut_disabled;
+  if (!_readField(EMC2101_LUT_DISABLE_FIELD, &lut_disabled) ||
+      !LUTEnabled(false)) {
     return false;
   }
-  if (!lut_pwm.write(scaled_pwm)) {
+  bool lut_enabled = !lut_disabled;
+  bool success = _writeLUTEntry(index, temp_thresh, fan_pwm);
+  // always put the LUT back the way we found it, even if the write failed
+  if (!LUTEnabled(lut_enabled)) {
     return false;
   }
-  LUTEnabled(lut_enabled);
-
-  return true;
+  return success;
 }
 
 /**
- * @brief Get the fan speed setting used while the LUT is being updated and is
- * unavailable or not in use. The speed is  given as the fan's PWM duty cycle
- * represented as a float percentage. The value **roughly** approximates the
- * percentage of the fan's maximum speed"""
+ * @brief Program several Look Up Table entries at once.
  *
- * @return float The current manually set fan duty cycle
+ * All entries are validated before anything is written, and the LUT is
+ * disabled once for the whole update and then restored to its previous state,
+ * even if one of the writes fails. Entries after `count` are given the
+ * maximum temperature threshold so they never take effect.
+ *
+ * The chip only supports single byte register writes, so this costs one
+ * transaction per register plus the LUT disable/restore:
+ * @code
+ * emc2101_lut_entry_t curve[] = {{20, 10}, {30, 25}, {40, 50}, {50, 100}};
+ * emc2101.setLUT(curve, 4);
+ * @endcode
+ *
+ * @param entries The entries to program, in order of strictly increasing
+ * temperature threshold
+ * @param count The number of entries, from 1-8
+ * @return true:success false:failure, or a transaction opened with
+ * `beginConfig` is pending
  */
-uint8_t Adafruit_EMC2101::getDutyCycle(void) {
-  Adafruit_BusIO_Register _fan_setting =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_REG_FAN_SETTING);
+bool Adafruit_EMC2101::setLUT(const emc2101_lut_entry_t *entries,
+                              uint8_t count) {
+  EMC2101_INSTRUMENT("setLUT(entries)");
+  BusGuard guard(this);
+  uint8_t regs[EMC2101_LUT_REGS];
+  if (_txn_open || !_buildLUT(entries, count, regs)) {
+    return false;
+  }
+
+  // don't touch the table unless we know how to put the LUT back afterwards
+  uint8_t lut_disabled;
+  if (!_readField(EMC2101_LUT_DISABLE_FIELD, &lut_disabled) ||
+      !LUTEnabled(false)) {
+    return false;
+  }
+  bool lut_enabled = !lut_disabled;
 
-  uint8_t raw_duty_cycle = _fan_setting.read() & MAX_LUT_SPEED;
-  return (uint8_t)((raw_duty_cycle / (float)MAX_LUT_SPEED) * 100);
+  bool success = _writeLUTRegs(regs);
+
+  // always put the LUT back the way we found it, even if a write failed
+  if (!LUTEnabled(lut_enabled)) {
+    return false;
+  }
+  return success;
 }
 
 /**
- * @brief Set the fan speed.
+ * @brief Replace the whole Look Up Table while the fan keeps running, such as
+ * to switch between quiet and performance cooling profiles, and check that
+ * the chip follows the new curve.
  *
+ * The fan is held at `safe_duty_raw` from the moment the LUT is disabled
+ * until the new table is enabled. The new table is then checked by forcing
+ * the temperature to the thresholds of its first, middle and last entries, in
+ * that order, and reading back the fan setting the LUT chose for each. If a
+ * check fails the previous table, LUT enable, forced temperature and manual
+ * fan setting are restored and false is returned.
  *
- * @param pwm_duty_cycle The  duty cycle percentage as an integer
- * The speed is  given as the fan's PWM duty cycle and **roughly** approximates
- * the percentage of the fan's maximum speed
- * @return true: success false: failure
+ * The swap is bounded: about 50 register transfers before retries, plus one
+ * fan setting read per conversion period while the checks wait for the LUT to
+ * follow the forced temperature, for no more than `timeout_ms` in total. A
+ * rollback adds about 20 transfers after that, which `timeout_ms` doesn't
+ * cover, so a failed swap takes at most `timeout_ms` plus about 70 transfers,
+ * each bounded by the `setRetries` settings. While the checks run the fan
+ * follows the forced temperatures, ending at the last entry's setting, rather
+ * than the measured temperature. On success the LUT is left enabled, using the
+ * measured temperature again unless forced temperature was enabled before.
+ *
+ * @code
+ * emc2101_lut_entry_t quiet[] = {{30, 0}, {45, 30}, {60, 60}, {70, 100}};
+ * if (!emc2101.swapLUT(quiet, 4)) {
+ *   // still running the previous profile
+ * }
+ * @endcode
+ *
+ * @param entries The entries to program, in order of strictly increasing
+ * temperature threshold
+ * @param count The number of entries, from 1-8
+ * @param safe_duty_raw The raw fan setting to hold while the table changes,
+ * from 0 to `MAX_LUT_SPEED`. Defaults to full speed
+ * @param timeout_ms The longest time to wait for the checks to pass
+ * @return true: the new table is in use false: invalid entries, a transaction
+ * opened with `beginConfig` is pending, or the swap failed and was rolled back
  */
-bool Adafruit_EMC2101::setDutyCycle(uint8_t pwm_duty_cycle) {
-  Adafruit_BusIO_Register _fan_setting =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_REG_FAN_SETTING);
+bool Adafruit_EMC2101::swapLUT(const emc2101_lut_entry_t *entries,
+                               uint8_t count, uint8_t safe_duty_raw,
+                               uint32_t timeout_ms) {
+  EMC2101_INSTRUMENT("swapLUT");
+  BusGuard guard(this);
+  uint8_t new_regs[EMC2101_LUT_REGS];
+  if (_txn_open || (safe_duty_raw > MAX_LUT_SPEED) ||
+      !_buildLUT(entries, count, new_regs)) {
+    return false;
+  }
 
-  // convert from a percentage to that percentage of the max duty cycle
-  pwm_duty_cycle = map(pwm_duty_cycle, 0, 100, 0, 63);
+  // save everything the rollback needs before changing anything
+  uint8_t old_regs[EMC2101_LUT_REGS];
+  uint8_t fan_config, fan_setting, forced_temp;
+  if (!_readCached(EMC2101_FAN_CONFIG, &fan_config) ||
+      !_read8(EMC2101_REG_FAN_SETTING, &fan_setting) ||
+      !_read8(EMC2101_TEMP_FORCE, &forced_temp)) {
+    return false;
+  }
+  for (uint8_t i = 0; i < EMC2101_LUT_REGS; i++) {
+    if (!_read8(EMC2101_LUT_START + i, old_regs + i)) {
+      return false;
+    }
+  }
+  uint8_t old_forced = EMC2101_FORCE_TEMP_FIELD.get(fan_config);
+  uint8_t old_lut_disabled = EMC2101_LUT_DISABLE_FIELD.get(fan_config);
+
+  // hold the fan at the safe setting while the table is changed and checked
+  bool held = LUTEnabled(false) &&
+              _write8(EMC2101_REG_FAN_SETTING, safe_duty_raw);
+  if (held && _writeLUTRegs(new_regs) &&
+      _verifyLUT(new_regs, count, timeout_ms)) {
+    _last_duty_raw = EMC2101_DUTY_UNKNOWN;
+    return _write8(EMC2101_TEMP_FORCE, forced_temp) &&
+           _writeField(EMC2101_FORCE_TEMP_FIELD, old_forced);
+  }
 
-  bool lut_enabled = LUTEnabled();
+  // roll back, keeping the fan at the safe setting until the old table is in
   LUTEnabled(false);
-  if (!_fan_setting.write(pwm_duty_cycle)) {
-    return false;
+  _write8(EMC2101_REG_FAN_SETTING, safe_duty_raw);
+  _writeLUTRegs(old_regs);
+  _write8(EMC2101_TEMP_FORCE, forced_temp);
+  if (old_lut_disabled) {
+    _write8(EMC2101_REG_FAN_SETTING, fan_setting);
   }
-  return LUTEnabled(lut_enabled);
+  bool restored = _writeFields(EMC2101_FORCE_TEMP_FIELD, old_forced,
+                               EMC2101_LUT_DISABLE_FIELD, old_lut_disabled);
+  _lut_known_disabled = restored && old_lut_disabled;
+  _last_duty_raw = EMC2101_DUTY_UNKNOWN;
+  return false;
 }
 
 /**
- * @brief Get the LUT enable status
+ * @brief Check LUT entries and work out the register values that program them.
+ * Entries after `count` are given the maximum temperature threshold so they
+ * never take effect
  *
- * @return true: LUT usage enabled false: LUT disabled
+ * @param entries The entries, in order of strictly increasing temperature
+ * threshold
+ * @param count The number of entries, from 1-8
+ * @param regs Buffer of `EMC2101_LUT_REGS` bytes to fill, in register order
+ * @return true: the entries are valid false: invalid entries
  */
-bool Adafruit_EMC2101::LUTEnabled(void) {
+bool Adafruit_EMC2101::_buildLUT(const emc2101_lut_entry_t *entries,
+                                 uint8_t count, uint8_t *regs) {
+  if (!entries || (count == 0) || (count > EMC2101_LUT_SIZE)) {
+    return false;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    if ((entries[i].temp_thresh > MAX_LUT_TEMP) ||
+        (entries[i].fan_pwm > 100)) {
+      return false;
+    }
+    if ((i > 0) && (entries[i].temp_thresh <= entries[i - 1].temp_thresh)) {
+      return false;
+    }
+  }
 
-  Adafruit_BusIO_Register fan_config =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_FAN_CONFIG);
-  Adafruit_BusIO_RegisterBits _lut_disable_bit =
-      Adafruit_BusIO_RegisterBits(&fan_config, 1, 5);
-  return !_lut_disable_bit.read();
+  for (uint8_t i = 0; i < EMC2101_LUT_SIZE; i++) {
+    const emc2101_lut_entry_t *entry = entries + min(i, (uint8_t)(count - 1));
+    regs[2 * i] = (i < count) ? entry->temp_thresh : MAX_LUT_TEMP;
+    regs[2 * i + 1] = emc2101_percent_to_duty_raw(entry->fan_pwm);
+  }
+  return true;
 }
 
 /**
- * @brief Enable or disable the temperature-to-fan speed Look Up Table (LUT)
+ * @brief Write the whole LUT. The LUT must already be disabled
  *
- * @param enable_lut True to enable the LUT, setting the fan speed depending on
- * the configured temp to speed mapping. False disables the LUT, defaulting to
- * the speed setting from `setDutyCycle`
- * @return true:success false: failure
+ * @param regs The `EMC2101_LUT_REGS` register values, in register order
+ * @return true: success false: failure
  */
-bool Adafruit_EMC2101::LUTEnabled(bool enable_lut) {
-
-  Adafruit_BusIO_Register fan_config =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_FAN_CONFIG);
-  Adafruit_BusIO_RegisterBits _lut_disable_bit =
-      Adafruit_BusIO_RegisterBits(&fan_config, 1, 5);
-  return _lut_disable_bit.write(!enable_lut);
+bool Adafruit_EMC2101::_writeLUTRegs(const uint8_t *regs) {
+  for (uint8_t i = 0; i < EMC2101_LUT_REGS; i++) {
+    if (!_write8(EMC2101_LUT_START + i, regs[i])) {
+      return false;
+    }
+  }
+  return true;
 }
 
 /**
- * @brief Get the mimnum RPM setting for the attached fan
+ * @brief Enable a newly written LUT driven by the forced temperature, and
+ * check the fan setting it chooses at the thresholds of its first, middle and
+ * last entries. The checks go up in temperature so the LUT hysteresis, which
+ * only applies to falling temperatures, can't hold a setting over
  *
- * @return uint16_t the current minimum RPM setting
+ * @param regs The LUT register values that were written
+ * @param count The number of entries in use, from 1-8
+ * @param timeout_ms The longest time to wait for all the checks to pass
+ * @return true: every check passed false: a check failed or timed out
  */
-uint16_t Adafruit_EMC2101::getFanMinRPM(void) {
-
-  uint8_t buffer[2];
-  Adafruit_BusIO_Register tach_limit_lsb =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_TACH_LIMIT_LSB);
-  Adafruit_BusIO_Register tach_limit_msb =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_TACH_LIMIT_MSB);
-  tach_limit_msb.read(buffer);
-  tach_limit_lsb.read(buffer + 1);
+bool Adafruit_EMC2101::_verifyLUT(const uint8_t *regs, uint8_t count,
+                                  uint32_t timeout_ms) {
+  uint32_t start_ms = millis();
+  uint16_t period_ms = emc2101_rate_period_ms(getDataRate());
+  if (period_ms == 0) {
+    // the rate couldn't be read: poll at the fastest rate rather than spin
+    period_ms = emc2101_rate_period_ms(EMC2101_RATE_32_HZ);
+  }
+  uint8_t probes[] = {0, (uint8_t)((count - 1) / 2), (uint8_t)(count - 1)};
 
-  uint16_t raw_limit = buffer[0] << 8;
-  raw_limit |= buffer[1];
-  if (raw_limit == 0xFFFF) {
-    return 0;
+  if (!_write8(EMC2101_TEMP_FORCE, regs[0]) ||
+      !_writeFields(EMC2101_FORCE_TEMP_FIELD, 1, EMC2101_LUT_DISABLE_FIELD,
+                    0)) {
+    return false;
+  }
+  _lut_known_disabled = false;
+
+  for (uint8_t p = 0; p < sizeof(probes); p++) {
+    uint8_t index = probes[p];
+    if ((p > 0) && (index == probes[p - 1])) {
+      continue;
+    }
+    if ((p > 0) && !_write8(EMC2101_TEMP_FORCE, regs[2 * index])) {
+      return false;
+    }
+
+    // the LUT picks up the forced temperature at its next conversion
+    while (true) {
+      uint8_t setting;
+      if (_read8(EMC2101_REG_FAN_SETTING, &setting) &&
+          ((setting & MAX_LUT_SPEED) == regs[2 * index + 1])) {
+        break;
+      }
+      uint32_t elapsed_ms = millis() - start_ms;
+      if (elapsed_ms >= timeout_ms) {
+        return false;
+      }
+      delay(min((uint32_t)period_ms, timeout_ms - elapsed_ms));
+    }
   }
-  return EMC2101_FAN_RPM_NUMERATOR / raw_limit;
+  return true;
 }
 
 /**
- * @brief Set the minimum speed of the attached fan
+ * @brief Write one LUT entry. The LUT must already be disabled
  *
- * Used to determine the fan state
- *
- * @param min_rpm The minimum speed of the fan. Any setting below this will
- * return 0 and mark the fan as non-operational
- * @return true: success false: failure
+ * @param index The index in the LUT, from 0-7
+ * @param temp_thresh The temperature threshold in degrees C
+ * @param fan_pwm The fan duty cycle as a percentage
+ * @return true:success false:failure
  */
-bool Adafruit_EMC2101::setFanMinRPM(uint16_t min_rpm) {
+bool Adafruit_EMC2101::_writeLUTEntry(uint8_t index, uint8_t temp_thresh,
+                                      uint8_t fan_pwm) {
+  uint8_t temp_reg_addr = EMC2101_LUT_START + (2 * index); // speed/pwm is +1
+  uint8_t scaled_pwm = emc2101_percent_to_duty_raw(fan_pwm);
 
-  Adafruit_BusIO_Register tach_limit_lsb =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_TACH_LIMIT_LSB);
-  Adafruit_BusIO_Register tach_limit_msb =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_TACH_LIMIT_MSB);
-  // speed is given in RPM, convert to raw value (MSB+LSB):
-  uint16_t raw_value = EMC2101_FAN_RPM_NUMERATOR / min_rpm;
-  if (!tach_limit_lsb.write(raw_value & 0xFF)) {
-    return false;
-  }
-  if (!tach_limit_msb.write((raw_value >> 8) & 0xFF)) {
+  if (!_write8(temp_reg_addr, temp_thresh)) {
     return false;
   }
-  return true;
+  return _write8(temp_reg_addr + 1, scaled_pwm);
 }
 
 /**
- * @brief Read the external temperature diode
+ * @brief Get the fan speed setting used while the LUT is being updated and is
+ * unavailable or not in use. The speed is  given as the fan's PWM duty cycle
+ * represented as a float percentage. The value **roughly** approximates the
+ * percentage of the fan's maximum speed"""
  *
- * @return float the current temperature in degrees C
+ * @return float The current manually set fan duty cycle
  */
-float Adafruit_EMC2101::getExternalTemperature(void) {
-  // chip doesn't like doing multi-byte reads so we'll get each byte separately
+uint8_t Adafruit_EMC2101::getDutyCycle(void) {
+  EMC2101_INSTRUMENT("getDutyCycle");
+  return emc2101_duty_raw_to_percent(getDutyCycleRaw());
+}
+
+/**
+ * @brief Get the fan speed setting as the raw 6-bit register value
+ *
+ * @return uint8_t The fan setting, from 0 to `MAX_LUT_SPEED`
+ */
+uint8_t Adafruit_EMC2101::getDutyCycleRaw(void) {
+  EMC2101_INSTRUMENT("getDutyCycleRaw");
+  return _readReg(EMC2101_REG_FAN_SETTING) & MAX_LUT_SPEED;
+}
+
+/**
+ * @brief Set the fan speed.
+ *
+ *
+ * @param pwm_duty_cycle The  duty cycle percentage as an integer
+ * The speed is  given as the fan's PWM duty cycle and **roughly** approximates
+ * the percentage of the fan's maximum speed
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setDutyCycle(uint8_t pwm_duty_cycle) {
+  EMC2101_INSTRUMENT("setDutyCycle");
+  if (pwm_duty_cycle > 100) {
+    return false;
+  }
+  return setDutyCycleRaw(emc2101_percent_to_duty_raw(pwm_duty_cycle));
+}
+
+/**
+ * @brief Set the fan speed as a raw 6-bit fan setting register value
+ *
+ * When the driver knows the LUT is disabled (after `LUTEnabled(false)` or a
+ * `resync()` that found it disabled) this is a single register write, and
+ * writing the value already in the register is skipped entirely. Otherwise the
+ * LUT is disabled around the write and restored, as with `setDutyCycle`.
+ *
+ * @param raw_duty_cycle The fan setting, from 0 to `MAX_LUT_SPEED`
+ * @return true: success false: failure, or a transaction opened with
+ * `beginConfig` is pending
+ */
+bool Adafruit_EMC2101::setDutyCycleRaw(uint8_t raw_duty_cycle) {
+  EMC2101_INSTRUMENT("setDutyCycleRaw");
+  BusGuard guard(this);
+  if (raw_duty_cycle > MAX_LUT_SPEED) {
+    return false;
+  }
+  if (_duty_batch_open) {
+    _duty_batch_value = raw_duty_cycle;
+    _duty_batch_pending = true;
+    return true;
+  }
+  if (_txn_open) {
+    return false; // the LUT may still be enabled until `commitConfig`
+  }
+  if (_lut_known_disabled && (raw_duty_cycle == _last_duty_raw)) {
+    return true;
+  }
+
+  if (_lut_known_disabled) {
+    if (!_write8(EMC2101_REG_FAN_SETTING, raw_duty_cycle)) {
+      _last_duty_raw = EMC2101_DUTY_UNKNOWN;
+      return false;
+    }
+    _last_duty_raw = raw_duty_cycle;
+    return true;
+  }
+
+  bool lut_enabled = LUTEnabled();
+  if (!LUTEnabled(false)) {
+    return false; // the LUT still owns the fan setting register
+  }
+  if (!_write8(EMC2101_REG_FAN_SETTING, raw_duty_cycle)) {
+    _last_duty_raw = EMC2101_DUTY_UNKNOWN;
+    return false;
+  }
+  _last_duty_raw = raw_duty_cycle;
+  return LUTEnabled(lut_enabled);
+}
+
+/**
+ * @brief Start collecting duty cycle updates instead of writing them.
+ *
+ * Calls to `setDutyCycle` and `setDutyCycleRaw` made before
+ * `endDutyCycleBatch()` only record the requested value, so a control tick that
+ * adjusts the duty cycle several times costs at most one write.
+ */
+void Adafruit_EMC2101::beginDutyCycleBatch(void) {
+  _duty_batch_open = true;
+  _duty_batch_pending = false;
+}
+
+/**
+ * @brief Write the last duty cycle requested since `beginDutyCycleBatch()`
+ *
+ * @return true: success or nothing to write false: failure
+ */
+bool Adafruit_EMC2101::endDutyCycleBatch(void) {
+  EMC2101_INSTRUMENT("endDutyCycleBatch");
+  BusGuard guard(this);
+  _duty_batch_open = false;
+  if (!_duty_batch_pending) {
+    return true;
+  }
+  _duty_batch_pending = false;
+  return setDutyCycleRaw(_duty_batch_value);
+}
+
+/**
+ * @brief Get the LUT enable status
+ *
+ * @return true: LUT usage enabled false: LUT disabled
+ */
+bool Adafruit_EMC2101::LUTEnabled(void) {
+  EMC2101_INSTRUMENT("LUTEnabled()");
+  return !_readField(EMC2101_LUT_DISABLE_FIELD);
+}
+
+/**
+ * @brief Enable or disable the temperature-to-fan speed Look Up Table (LUT)
+ *
+ * @param enable_lut True to enable the LUT, setting the fan speed depending on
+ * the configured temp to speed mapping. False disables the LUT, defaulting to
+ * the speed setting from `setDutyCycle`
+ * @return true:success false: failure
+ */
+bool Adafruit_EMC2101::LUTEnabled(bool enable_lut) {
+  EMC2101_INSTRUMENT("LUTEnabled(bool)");
+  if (!_writeField(EMC2101_LUT_DISABLE_FIELD, !enable_lut)) {
+    _lut_known_disabled = false;
+    return false;
+  }
+  // a staged change takes effect in `commitConfig`
+  _lut_known_disabled = !enable_lut && !_txn_open;
+  if (enable_lut) {
+    // the LUT now owns the fan setting register
+    _last_duty_raw = EMC2101_DUTY_UNKNOWN;
+  }
+  return true;
+}
+
+/**
+ * @brief Get the mimnum RPM setting for the attached fan
+ *
+ * @return uint16_t the current minimum RPM setting, 0 if the read failed
+ */
+uint16_t Adafruit_EMC2101::getFanMinRPM(void) {
+  EMC2101_INSTRUMENT("getFanMinRPM");
+  BusGuard guard(this);
+  uint8_t buffer[2];
+  if (!_read8(EMC2101_TACH_LIMIT_MSB, buffer) ||
+      !_read8(EMC2101_TACH_LIMIT_LSB, buffer + 1)) {
+    return 0;
+  }
+
+  uint16_t raw_limit = buffer[0] << 8;
+  raw_limit |= buffer[1];
+  return emc2101_tach_to_rpm(raw_limit);
+}
+
+/**
+ * @brief Set the minimum speed of the attached fan
+ *
+ * Used to determine the fan state
+ *
+ * @param min_rpm The minimum speed of the fan. Any setting below this will
+ * return 0 and mark the fan as non-operational
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setFanMinRPM(uint16_t min_rpm) {
+  EMC2101_INSTRUMENT("setFanMinRPM");
+  BusGuard guard(this);
+  // speed is given in RPM, convert to raw value (MSB+LSB):
+  uint16_t raw_value = emc2101_rpm_to_tach(min_rpm);
+  if (!_write8(EMC2101_TACH_LIMIT_LSB, raw_value & 0xFF)) {
+    return false;
+  }
+  if (!_write8(EMC2101_TACH_LIMIT_MSB, (raw_value >> 8) & 0xFF)) {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Read the external temperature diode
+ *
+ * @return float the current temperature in degrees C, NAN if the read failed
+ */
+float Adafruit_EMC2101::getExternalTemperature(void) {
+  EMC2101_INSTRUMENT("getExternalTemperature");
+  int16_t raw_ext = getExternalTemperatureRaw();
+  if (raw_ext == EMC2101_TEMP_RAW_ERROR) {
+    return NAN;
+  }
+  return raw_ext * _TEMP_LSB;
+}
+
+/**
+ * @brief Read the external temperature diode without any floating point math
+ *
+ * Use `emc2101_temp_raw_to_centi_c` to convert the result to hundredths of a
+ * degree C
+ *
+ * @return int16_t the current temperature in 1/8 degree C steps,
+ * `EMC2101_TEMP_RAW_ERROR` if the read failed
+ */
+int16_t Adafruit_EMC2101::getExternalTemperatureRaw(void) {
+  EMC2101_INSTRUMENT("getExternalTemperatureRaw");
+  BusGuard guard(this);
+  uint32_t now = millis();
+  if (_track_conversions && _ext_temp_valid &&
+      ((int32_t)(now - _ext_temp_next_ms) < 0)) {
+    _stale_reads++;
+    return _ext_temp_cache;
+  }
+
+  // chip doesn't like doing multi-byte reads so we'll get each byte separately
   // and join
   uint8_t buffer[2];
-  Adafruit_BusIO_Register ext_temp_lsb =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_EXTERNAL_TEMP_LSB);
-  Adafruit_BusIO_Register ext_temp_msb =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_EXTERNAL_TEMP_MSB);
 
   // Read **MSB** first to match 'Data Read Interlock' behavoior from 6.1 of
   // datasheet
-  ext_temp_msb.read(buffer);
-  ext_temp_lsb.read(buffer + 1);
+  if (!_finishInterlock() || !_read8(EMC2101_EXTERNAL_TEMP_MSB, buffer) ||
+      !_read8(EMC2101_EXTERNAL_TEMP_LSB, buffer + 1)) {
+    return EMC2101_TEMP_RAW_ERROR;
+  }
 
   int16_t raw_ext = buffer[0] << 8;
   raw_ext |= buffer[1];
 
-  raw_ext >>= 5;
-  return raw_ext * _TEMP_LSB;
+  _ext_temp_cache = raw_ext >> 5;
+  _ext_temp_valid = true;
+  _ext_temp_next_ms = _nextConversion(now);
+  return _ext_temp_cache;
 }
 
 /**
  * @brief Read the internal temperature sensor
  *
- * @return int8_t the current temperature in degrees celcius
+ * @return int8_t the current temperature in degrees celcius,
+ * `EMC2101_TEMP_ERROR` if the read failed
  */
 int8_t Adafruit_EMC2101::getInternalTemperature(void) {
-  // _INTERNAL_TEMP = const(0x00)
-  Adafruit_BusIO_Register int_temp_lsb =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_INTERNAL_TEMP);
+  EMC2101_INSTRUMENT("getInternalTemperature");
+  BusGuard guard(this);
+  uint32_t now = millis();
+  if (_track_conversions && _int_temp_valid &&
+      ((int32_t)(now - _int_temp_next_ms) < 0)) {
+    _stale_reads++;
+    return _int_temp_cache;
+  }
+
+  uint8_t raw_int;
+  if (!_read8(EMC2101_INTERNAL_TEMP, &raw_int)) {
+    return EMC2101_TEMP_ERROR;
+  }
+  _int_temp_cache = (int8_t)raw_int;
+  _int_temp_valid = true;
+  _int_temp_next_ms = _nextConversion(now);
+  return _int_temp_cache;
+}
+
+/**
+ * @brief Only read temperatures from the chip once a new conversion is due.
+ *
+ * While enabled, `getInternalTemperature` and `getExternalTemperature` (and
+ * their raw versions) return the last value read until the conversion period
+ * set with `setDataRate` has passed, and count each such call in
+ * `staleReadCount`. Conversion boundaries are estimated from the data rate;
+ * `syncToConversion` lines them up with the chip's actual conversions.
+ *
+ * @param enable_tracking true to enable, false to read the chip on every call
+ * @return true: success false: the data rate could not be read
+ */
+bool Adafruit_EMC2101::enableConversionTracking(bool enable_tracking) {
+  EMC2101_INSTRUMENT("enableConversionTracking");
+  BusGuard guard(this);
+  _track_conversions = false;
+  _int_temp_valid = _ext_temp_valid = false;
+  if (!enable_tracking) {
+    return true;
+  }
+  uint8_t rate;
+  if (!_read8(EMC2101_REG_DATA_RATE, &rate)) {
+    return false;
+  }
+  _conversion_period_ms = emc2101_rate_period_ms((emc2101_rate_t)(rate & 0xF));
+  _track_conversions = (_conversion_period_ms != 0);
+  return true;
+}
+
+/**
+ * @brief Wait for the chip to finish a conversion and use that moment as the
+ * reference for conversion boundaries. Uses the BUSY status bit, so this polls
+ * the status register until a conversion ends. Reading the status clears its
+ * latched alert bits, so any seen here are kept for the next `getStatus` or
+ * `serviceAlert`
+ *
+ * @param timeout_ms How long to wait. Should be more than one conversion
+ * period
+ * @return true: synchronized false: timed out or bus failure
+ */
+bool Adafruit_EMC2101::syncToConversion(uint32_t timeout_ms) {
+  EMC2101_INSTRUMENT("syncToConversion");
+  BusGuard guard(this);
+  uint32_t start = millis();
+  bool seen_busy = false;
+  while ((millis() - start) < timeout_ms) {
+    uint8_t status;
+    if (!_read8(EMC2101_STATUS, &status)) {
+      return false;
+    }
+    _pending_status |= status & ~EMC2101_STATUS_BUSY;
+    if (status & EMC2101_STATUS_BUSY) {
+      seen_busy = true;
+    } else if (seen_busy) {
+      _conversion_epoch_ms = millis();
+      _int_temp_valid = _ext_temp_valid = false;
+      return true;
+    }
+    delay(1);
+  }
+  return false;
+}
+
+/**
+ * @brief Get how long until the next conversion result is expected
+ *
+ * @return uint32_t The time in milliseconds, 0 when not tracking conversions
+ */
+uint32_t Adafruit_EMC2101::msUntilNextConversion(void) {
+  if (!_track_conversions) {
+    return 0;
+  }
+  uint32_t now = millis();
+  return _nextConversion(now) - now;
+}
+
+/**
+ * @brief Delay until the next conversion result is expected, to run a loop in
+ * step with the chip's data rate
+ *
+ */
+void Adafruit_EMC2101::waitForConversion(void) {
+  EMC2101_INSTRUMENT("waitForConversion");
+  delay(msUntilNextConversion());
+}
+
+/**
+ * @brief Get the number of temperature reads answered from the cache because
+ * no new conversion was due
+ *
+ * @return uint32_t The number of reads that skipped the bus
+ */
+uint32_t Adafruit_EMC2101::staleReadCount(void) { return _stale_reads; }
 
-  return (int8_t)int_temp_lsb.read();
+/**
+ * @brief Find the first conversion boundary after a time
+ *
+ * @param now_ms The time
+ * @return uint32_t The time of the next boundary
+ */
+uint32_t Adafruit_EMC2101::_nextConversion(uint32_t now_ms) {
+  if (_conversion_period_ms == 0) {
+    return now_ms;
+  }
+  uint32_t elapsed = now_ms - _conversion_epoch_ms;
+  return now_ms + _conversion_period_ms - (elapsed % _conversion_period_ms);
 }
 
 /**
  * @brief Read the current fan speed in RPM.
  *
- * @return uint16_t The current fan speed, 0 if no tachometer input
+ * @return uint16_t The current fan speed, 0 if no tachometer input or the
+ * read failed
  */
 uint16_t Adafruit_EMC2101::getFanRPM(void) {
+  EMC2101_INSTRUMENT("getFanRPM");
+  return emc2101_tach_to_rpm(getFanTachRaw());
+}
+
+/**
+ * @brief Read the raw tachometer count, which is inversely proportional to the
+ * fan speed.
+ *
+ * Comparing this against a limit made with `emc2101_rpm_to_tach` avoids the
+ * division needed to convert it to RPM
+ *
+ * @return uint16_t The tach count, 0xFFFF if the fan is stopped or the read
+ * failed. Check `lastError` to tell the two apart
+ */
+uint16_t Adafruit_EMC2101::getFanTachRaw(void) {
+  uint16_t tach = 0xFFFF;
+  getFanTachRaw(&tach);
+  return tach;
+}
+
+/**
+ * @brief Read the raw tachometer count, reporting the result of this read
+ * alone. Unlike `lastError`, this isn't affected by earlier failures, so
+ * callers don't need to clear the sticky error first
+ *
+ * @param tach Where to store the tach count, 0xFFFF if the fan is stopped.
+ * Unchanged on failure
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::getFanTachRaw(uint16_t *tach) {
+  EMC2101_INSTRUMENT("getFanTachRaw");
+  BusGuard guard(this);
   uint8_t buffer[2];
-  Adafruit_BusIO_Register fan_speed_lsb =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_TACH_LSB);
-  Adafruit_BusIO_Register fan_speed_msb =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_TACH_MSB);
 
   // Read LSB first to match 'Data Read Interlock' behavoior from 6.1 of
   // datasheet
-  fan_speed_lsb.read(buffer + 1);
-  fan_speed_msb.read(buffer);
+  if (!_finishInterlock() || !_read8(EMC2101_TACH_LSB, buffer + 1) ||
+      !_read8(EMC2101_TACH_MSB, buffer)) {
+    return false;
+  }
 
   uint16_t raw_ext = buffer[0] << 8;
   raw_ext |= buffer[1];
+  *tach = raw_ext;
+  return true;
+}
 
-  if (raw_ext == 0xFFFF) {
-    return 0;
+/**
+ * @brief Read all of the commonly monitored values in one pass
+ *
+ * Reads the internal and external temperatures, the status register, the
+ * tachometer and the fan setting register with one single byte read each,
+ * following the 'Data Read Interlock' ordering used by
+ * `getExternalTemperature` and `getFanRPM`. Reading the status register clears
+ * any latched alert bits; bits latched when `syncToConversion` read it are
+ * included once. The result is also published for
+ * `getPublishedSnapshot`.
+ *
+ * @param out The snapshot to fill
+ * @return true: success false: failure. `out` is only partially filled on
+ * failure
+ */
+bool Adafruit_EMC2101::readSnapshot(emc2101_snapshot_t *out) {
+  EMC2101_INSTRUMENT("readSnapshot");
+  BusGuard guard(this);
+  if (!out || !_finishInterlock()) {
+    return false;
+  }
+  uint8_t buffer[EMC2101_SNAPSHOT_STEPS];
+  for (uint8_t i = 0; i < EMC2101_SNAPSHOT_STEPS; i++) {
+    if (!_read8(_snapshot_regs[i], buffer + i)) {
+      return false;
+    }
   }
+  _fillSnapshot(buffer, out);
+  return true;
+}
 
-  return EMC2101_FAN_RPM_NUMERATOR / raw_ext;
+/**
+ * @brief Start reading a snapshot without blocking. Each call to `poll()`
+ * then performs at most one single byte register read, and `callback` is
+ * called from `poll()` once the snapshot is complete.
+ *
+ * @code
+ * emc2101.startSnapshot(&snapshot, onSnapshot);
+ * // in loop():
+ * if (emc2101.poll() == EMC2101_ASYNC_ERROR) {
+ *   // retry, or report the failure
+ * }
+ * @endcode
+ *
+ * @param out The snapshot to fill. Must remain valid until the read finishes
+ * @param callback Optional function to call with `out` when it is complete
+ * @return true: the read was started false: a read is already in progress
+ */
+bool Adafruit_EMC2101::startSnapshot(emc2101_snapshot_t *out,
+                                     emc2101_snapshot_callback_t callback) {
+  if (!out || (_async_out != NULL)) {
+    return false;
+  }
+  _async_out = out;
+  _async_callback = callback;
+  _async_step = 0;
+  return true;
+}
+
+/**
+ * @brief Advance a read started by `startSnapshot` by one register read.
+ *
+ * When a lock is set with `setBusLock`, the external temperature and tach
+ * register pairs are each read in a single call instead, so another task
+ * can't read between the two halves of a 'Data Read Interlock' pair. Without
+ * one, the blocking reads of those pairs read the half `poll()` left first
+ *
+ * @return emc2101_async_status_t `EMC2101_ASYNC_IN_PROGRESS` while there are
+ * registers left to read, `EMC2101_ASYNC_DONE` on the call that completes the
+ * snapshot, `EMC2101_ASYNC_ERROR` if a read failed, which abandons the
+ * snapshot, or `EMC2101_ASYNC_IDLE` if no read was started
+ */
+emc2101_async_status_t Adafruit_EMC2101::poll(void) {
+  EMC2101_INSTRUMENT("poll");
+  BusGuard guard(this);
+  if (_async_out == NULL) {
+    return EMC2101_ASYNC_IDLE;
+  }
+  do {
+    if (!_read8(_snapshot_regs[_async_step], _async_buffer + _async_step)) {
+      _async_out = NULL;
+      return EMC2101_ASYNC_ERROR;
+    }
+    _async_step++;
+    // steps 1 and 4 start the temperature and tach interlock pairs
+  } while (_lock_fn && ((_async_step == 2) || (_async_step == 5)));
+  if (_async_step < EMC2101_SNAPSHOT_STEPS) {
+    return EMC2101_ASYNC_IN_PROGRESS;
+  }
+
+  emc2101_snapshot_t *out = _async_out;
+  _async_out = NULL; // allow the callback to start the next snapshot
+  _fillSnapshot(_async_buffer, out);
+  if (_async_callback) {
+    _async_callback(out);
+  }
+  return EMC2101_ASYNC_DONE;
+}
+
+/**
+ * @brief Abandon a read started by `startSnapshot`. If it stopped between the
+ * two halves of a 'Data Read Interlock' pair, the second half is read first so
+ * the chip isn't left holding a latched byte
+ *
+ * @return true: success false: the second half could not be read. The read is
+ * abandoned either way
+ */
+bool Adafruit_EMC2101::cancelSnapshot(void) {
+  EMC2101_INSTRUMENT("cancelSnapshot");
+  BusGuard guard(this);
+  bool success = _finishInterlock();
+  _async_out = NULL;
+  return success;
+}
+
+/**
+ * @brief Read the second half of an interlock pair `poll()` has started, so
+ * that reading the pair again doesn't replace the byte the chip latched for it
+ *
+ * @return true: success, or no pair is open false: bus failure, which
+ * abandons the snapshot
+ */
+bool Adafruit_EMC2101::_finishInterlock(void) {
+  // steps 2 and 5 end the temperature and tach interlock pairs
+  if (!_async_out || ((_async_step != 2) && (_async_step != 5))) {
+    return true;
+  }
+  if (!_read8(_snapshot_regs[_async_step], _async_buffer + _async_step)) {
+    _async_out = NULL;
+    return false;
+  }
+  _async_step++;
+  return true;
+}
+
+/**
+ * @brief Convert the registers read for a snapshot and publish it for
+ * `getPublishedSnapshot`. Bits kept by `syncToConversion` are added to the
+ * status, as `getStatus` does. Call with the bus lock held
+ *
+ * @param buffer The register values, in the order of `_snapshot_regs`
+ * @param out The snapshot to fill
+ */
+void Adafruit_EMC2101::_fillSnapshot(const uint8_t *buffer,
+                                     emc2101_snapshot_t *out) {
+  out->internal_temp = (int8_t)buffer[0];
+
+  int16_t raw_ext = (buffer[1] << 8) | buffer[2];
+  out->external_temp_raw = raw_ext >> 5;
+  out->external_temp = out->external_temp_raw * _TEMP_LSB;
+
+  out->status = buffer[3] | _pending_status;
+  _pending_status = 0;
+
+  out->tach_raw = (buffer[5] << 8) | buffer[4];
+  out->fan_rpm = emc2101_tach_to_rpm(out->tach_raw);
+
+  out->duty_raw = buffer[6] & MAX_LUT_SPEED;
+  out->duty_cycle = emc2101_duty_raw_to_percent(out->duty_raw);
+
+  _publish(out);
+}
+
+/**
+ * @brief Get the first error since the last call to `clearError`.
+ *
+ * Errors are sticky, so several accessors can be called and checked once:
+ * @code
+ * emc2101.clearError();
+ * float temp = emc2101.getExternalTemperature();
+ * uint16_t rpm = emc2101.getFanRPM();
+ * if (emc2101.lastError() != EMC2101_OK) {
+ *   // don't act on temp or rpm
+ * }
+ * @endcode
+ *
+ * @return emc2101_error_t `EMC2101_OK` if no transfer has failed
+ */
+emc2101_error_t Adafruit_EMC2101::lastError(void) { return _last_error; }
+
+/**
+ * @brief Reset the error reported by `lastError` to `EMC2101_OK`
+ */
+void Adafruit_EMC2101::clearError(void) { _last_error = EMC2101_OK; }
+
+/**
+ * @brief Set how failed register transfers are retried. The delay doubles
+ * after each attempt, up to 65535us, so the default of 2 retries starting at
+ * 50us gives up after about 150us plus the transfers themselves
+ *
+ * @param retries Extra attempts to make after a failed transfer, 0 to fail
+ * right away
+ * @param backoff_us The delay before the first retry, in microseconds
+ */
+void Adafruit_EMC2101::setRetries(uint8_t retries, uint16_t backoff_us) {
+  _retries = retries;
+  _retry_backoff_us = backoff_us;
+}
+
+/**
+ * @brief Set a function to free a stuck bus, such as by clocking SCL until
+ * SDA is released and calling `Wire.begin()` again. It is called in place of
+ * the backoff delay before the last retry of a failed transfer, so it is
+ * only used when `setRetries` allows at least one retry
+ *
+ * @param recovery The function to call, or NULL for none
+ */
+void Adafruit_EMC2101::setBusRecovery(emc2101_bus_recovery_t recovery) {
+  _bus_recovery = recovery;
+}
+
+/**
+ * @brief Get the bus transfer counters for this device
+ *
+ * @param stats The counters to fill
+ */
+void Adafruit_EMC2101::getBusStats(emc2101_bus_stats_t *stats) {
+  if (stats) {
+    *stats = _bus_stats;
+  }
+}
+
+/**
+ * @brief Reset the bus transfer counters to zero
+ */
+void Adafruit_EMC2101::resetBusStats(void) {
+  memset(&_bus_stats, 0, sizeof(_bus_stats));
+}
+
+/**
+ * @brief Set the lock held around every bus transfer and every sequence of
+ * transfers that must not be interleaved with another task's, such as the
+ * read-modify-write of a config register, the LUT disable/restore around
+ * `setLUT` and the MSB/LSB 'Data Read Interlock' pairs.
+ *
+ * Pass the same lock to every device on a bus. Public methods call each other
+ * with the lock held, so it must be recursive, such as a FreeRTOS recursive
+ * mutex or a `PTHREAD_MUTEX_RECURSIVE` mutex:
+ * @code
+ * SemaphoreHandle_t bus_mutex = xSemaphoreCreateRecursiveMutex();
+ * emc2101.setBusLock(
+ *     [](void *m) { xSemaphoreTakeRecursive(m, portMAX_DELAY); },
+ *     [](void *m) { xSemaphoreGiveRecursive(m); }, bus_mutex);
+ * @endcode
+ *
+ * @param lock Function that takes the lock, or NULL for no locking
+ * @param unlock Function that releases the lock
+ * @param context Passed to `lock` and `unlock`, usually the mutex
+ */
+void Adafruit_EMC2101::setBusLock(emc2101_lock_fn_t lock,
+                                  emc2101_lock_fn_t unlock, void *context) {
+  _lock_fn = unlock ? lock : NULL;
+  _unlock_fn = unlock;
+  _lock_context = context;
+}
+
+/**
+ * @brief Take the bus lock, if one is set
+ *
+ * @param emc2101 The driver whose lock to take
+ */
+Adafruit_EMC2101::BusGuard::BusGuard(Adafruit_EMC2101 *emc2101) {
+  _emc2101 = emc2101;
+  if (_emc2101->_lock_fn) {
+    _emc2101->_lock_fn(_emc2101->_lock_context);
+  }
+}
+
+/**
+ * @brief Release the bus lock, if one is set
+ */
+Adafruit_EMC2101::BusGuard::~BusGuard() {
+  if (_emc2101->_lock_fn) {
+    _emc2101->_unlock_fn(_emc2101->_lock_context);
+  }
+}
+
+/**
+ * @brief Get the last snapshot read by `readSnapshot` or `poll`, without
+ * touching the bus or taking the bus lock. Safe to call from another core or
+ * task while the snapshot is being updated, since the copy is retried if it
+ * overlaps an update.
+ *
+ * Publishing is only safe with a single writer: either set a lock with
+ * `setBusLock`, or read snapshots from one task only. Two tasks reading
+ * snapshots without a lock can publish a torn snapshot that this returns as
+ * valid
+ *
+ * @param out The snapshot to fill
+ * @return true: success false: no snapshot has been read yet, or every
+ * attempt overlapped an update
+ */
+bool Adafruit_EMC2101::getPublishedSnapshot(emc2101_snapshot_t *out) {
+  if (!out) {
+    return false;
+  }
+  for (uint8_t i = 0; i < EMC2101_SEQLOCK_TRIES; i++) {
+    uint32_t seq = _published_seq;
+    EMC2101_MEMORY_BARRIER();
+    if (seq == 0) {
+      return false;
+    }
+    if (seq & 1) {
+      continue; // an update is in progress
+    }
+    *out = _published;
+    EMC2101_MEMORY_BARRIER();
+    if (_published_seq == seq) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Publish a snapshot for `getPublishedSnapshot`. Must be called with
+ * the bus lock held, or with snapshots only read from one task, so there is
+ * only ever one writer
+ *
+ * @param snapshot The snapshot to publish
+ */
+void Adafruit_EMC2101::_publish(const emc2101_snapshot_t *snapshot) {
+  _published_seq = _published_seq + 1; // odd: readers retry
+  EMC2101_MEMORY_BARRIER();
+  _published = *snapshot;
+  EMC2101_MEMORY_BARRIER();
+  _published_seq = _published_seq + 1;
+}
+
+/**
+ * @brief Read or write a single register, retrying failed attempts with an
+ * increasing delay and updating the error state and transfer counters
+ *
+ * @param reg_addr The register address
+ * @param value The value to write, or where to store the value read
+ * @param read true to read the register, false to write it
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::_transfer(uint8_t reg_addr, uint8_t *value,
+                                 bool read) {
+  BusGuard guard(this);
+  if (!_transport) {
+    _last_error = EMC2101_ERROR_NOT_STARTED;
+    return false;
+  }
+
+  uint32_t start_us = micros();
+  uint16_t backoff_us = _retry_backoff_us;
+  uint8_t bytes = read ? EMC2101_BUS_READ_BYTES : EMC2101_BUS_WRITE_BYTES;
+  bool success;
+  for (uint8_t attempt = 0;; attempt++) {
+    EMC2101_INSTRUMENT_TRANSFER(bytes);
+    _bus_stats.bytes += bytes;
+    if (read) {
+      success = _transport->read8(reg_addr, value);
+    } else {
+      success = _transport->write8(reg_addr, *value);
+    }
+    if (success || (attempt >= _retries)) {
+      break;
+    }
+    _bus_stats.retries++;
+    if (_bus_recovery && (attempt + 1 == _retries)) {
+      _bus_stats.recoveries++;
+      _bus_recovery();
+    } else {
+      delayMicroseconds(backoff_us);
+      backoff_us = (backoff_us > 0x7FFF) ? 0xFFFF : backoff_us * 2;
+    }
+  }
+
+  uint32_t elapsed_us = micros() - start_us;
+  _bus_stats.transfers++;
+  _bus_stats.total_us += elapsed_us;
+  if (elapsed_us > _bus_stats.max_us) {
+    _bus_stats.max_us = elapsed_us;
+  }
+  if (!success) {
+    _bus_stats.errors++;
+    if (_last_error == EMC2101_OK) {
+      _last_error = read ? EMC2101_ERROR_READ : EMC2101_ERROR_WRITE;
+    }
+  }
+  return success;
+}
+
+/**
+ * @brief Read a single register
+ *
+ * @param reg_addr The register address
+ * @param value Where to store the register contents
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::_read8(uint8_t reg_addr, uint8_t *value) {
+  return _transfer(reg_addr, value, true);
+}
+
+/**
+ * @brief Read a single register for accessors that return the value directly
+ *
+ * @param reg_addr The register address
+ * @return uint8_t The register contents, 0xFF if the read failed
+ */
+uint8_t Adafruit_EMC2101::_readReg(uint8_t reg_addr) {
+  uint8_t value = 0xFF;
+  _read8(reg_addr, &value);
+  return value;
+}
+
+/**
+ * @brief Write a single register
+ *
+ * @param reg_addr The register address
+ * @param value The value to write
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::_write8(uint8_t reg_addr, uint8_t value) {
+  return _transfer(reg_addr, &value, false);
 }
 
 /**
@@ -496,13 +1949,9 @@ uint16_t Adafruit_EMC2101::getFanRPM(void) {
  * @return emc2101_rate_t The current data rate
  */
 emc2101_rate_t Adafruit_EMC2101::getDataRate(void) {
-  Adafruit_BusIO_Register rate_reg =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_REG_DATA_RATE, 1);
-  Adafruit_BusIO_RegisterBits data_rate =
-      Adafruit_BusIO_RegisterBits(&rate_reg, 4, 0);
+  EMC2101_INSTRUMENT("getDataRate");
   // _conversion_rate = RWBits(4, 0x04, 0)
-
-  return (emc2101_rate_t)data_rate.read();
+  return (emc2101_rate_t)_readField(EMC2101_DATA_RATE_FIELD);
 }
 
 /**
@@ -512,12 +1961,111 @@ emc2101_rate_t Adafruit_EMC2101::getDataRate(void) {
  * @return bool true:success false:failure
  */
 bool Adafruit_EMC2101::setDataRate(emc2101_rate_t new_data_rate) {
-  Adafruit_BusIO_Register rate_reg =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_REG_DATA_RATE, 1);
-  Adafruit_BusIO_RegisterBits data_rate =
-      Adafruit_BusIO_RegisterBits(&rate_reg, 4, 0);
+  EMC2101_INSTRUMENT("setDataRate");
+  if (!_writeField(EMC2101_DATA_RATE_FIELD, new_data_rate)) {
+    return false;
+  }
+  _dataRateChanged(new_data_rate);
+  return true;
+}
 
-  return data_rate.write(new_data_rate);
+/**
+ * @brief Update conversion tracking after the data rate was written
+ *
+ * @param data_rate The new data rate
+ */
+void Adafruit_EMC2101::_dataRateChanged(emc2101_rate_t data_rate) {
+  if (_track_conversions) {
+    _conversion_period_ms = emc2101_rate_period_ms(data_rate);
+    _track_conversions = (_conversion_period_ms != 0);
+    _int_temp_valid = _ext_temp_valid = false;
+  }
+}
+
+/**
+ * @brief Get the external temperature digital filter setting
+ *
+ * @return emc2101_filter_t The current filter level
+ */
+emc2101_filter_t Adafruit_EMC2101::getFilter(void) {
+  EMC2101_INSTRUMENT("getFilter");
+  uint8_t filter = _readField(EMC2101_FILTER_FIELD);
+  // both upper settings select level 2
+  return (emc2101_filter_t)min(filter, (uint8_t)EMC2101_FILTER_LEVEL_2);
+}
+
+/**
+ * @brief Set the external temperature digital filter. Filtering on the chip
+ * reduces the noise from a remote diode on a long trace without the bus
+ * traffic of averaging many `getExternalTemperature` reads, at the cost of
+ * the reading taking a few more conversions to follow a change. See the
+ * filter_noise example to measure the tradeoff for a given board
+ *
+ * @param filter The filter level. Must be a `emc2101_filter_t`
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setFilter(emc2101_filter_t filter) {
+  EMC2101_INSTRUMENT("setFilter");
+  if (filter > EMC2101_FILTER_LEVEL_2) {
+    return false;
+  }
+  return _writeField(EMC2101_FILTER_FIELD, filter);
+}
+
+/**
+ * @brief Get the ideality factor setting for the external diode
+ *
+ * @return uint8_t The 6-bit ideality setting
+ */
+uint8_t Adafruit_EMC2101::getIdealityFactor(void) {
+  EMC2101_INSTRUMENT("getIdealityFactor");
+  return _readField(EMC2101_IDEALITY_FIELD);
+}
+
+/**
+ * @brief Set the ideality factor the chip assumes for the external diode, so
+ * diodes and transistors other than the common 1.008 ideality ones read
+ * correctly. Settings are from the ideality factor table of the datasheet
+ *
+ * @param ideality The 6-bit ideality setting, `EMC2101_IDEALITY_DEFAULT` for
+ * an ideality factor of 1.008
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setIdealityFactor(uint8_t ideality) {
+  EMC2101_INSTRUMENT("setIdealityFactor");
+  if (ideality > EMC2101_IDEALITY_FIELD.max_value) {
+    return false;
+  }
+  return _writeField(EMC2101_IDEALITY_FIELD, ideality);
+}
+
+/**
+ * @brief Get the beta compensation setting for the external diode
+ *
+ * @return uint8_t `EMC2101_BETA_AUTO`, `EMC2101_BETA_DISABLED` or a manual
+ * setting from 0-6
+ */
+uint8_t Adafruit_EMC2101::getBetaCompensation(void) {
+  EMC2101_INSTRUMENT("getBetaCompensation");
+  uint8_t beta = _readField(EMC2101_BETA_FIELD);
+  return (beta & EMC2101_BETA_AUTO) ? EMC2101_BETA_AUTO : beta;
+}
+
+/**
+ * @brief Set the beta compensation for a substrate transistor used as the
+ * external diode, such as the thermal diode of a CPU or FPGA
+ *
+ * @param beta `EMC2101_BETA_AUTO` to detect the transistor's beta, the
+ * default, `EMC2101_BETA_DISABLED` for a discrete diode or diode-connected
+ * transistor, or a manual setting from 0-6 from the datasheet
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setBetaCompensation(uint8_t beta) {
+  EMC2101_INSTRUMENT("setBetaCompensation");
+  if (beta > EMC2101_BETA_AUTO) {
+    return false;
+  }
+  return _writeField(EMC2101_BETA_FIELD, beta);
 }
 
 /**
@@ -528,14 +2076,8 @@ bool Adafruit_EMC2101::setDataRate(emc2101_rate_t new_data_rate) {
  * @return true:success false: failure
  */
 bool Adafruit_EMC2101::DACOutEnabled(bool enable_dac_out) {
-  Adafruit_BusIO_Register reg_config =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_REG_CONFIG);
-  Adafruit_BusIO_RegisterBits dac_output_enabled_bit =
-      Adafruit_BusIO_RegisterBits(&reg_config, 1, 4);
-  if (!dac_output_enabled_bit.write(enable_dac_out)) {
-    return false;
-  }
-  return true;
+  EMC2101_INSTRUMENT("DACOutEnabled(bool)");
+  return _writeField(EMC2101_DAC_FIELD, enable_dac_out);
 }
 
 /**
@@ -545,11 +2087,8 @@ bool Adafruit_EMC2101::DACOutEnabled(bool enable_dac_out) {
  * @return false DAC output disabled
  */
 bool Adafruit_EMC2101::DACOutEnabled(void) {
-  Adafruit_BusIO_Register reg_config =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_REG_CONFIG);
-  Adafruit_BusIO_RegisterBits dac_output_enabled_bit =
-      Adafruit_BusIO_RegisterBits(&reg_config, 1, 4);
-  return dac_output_enabled_bit.read();
+  EMC2101_INSTRUMENT("DACOutEnabled()");
+  return _readField(EMC2101_DAC_FIELD);
 }
 
 /**
@@ -562,9 +2101,10 @@ bool Adafruit_EMC2101::DACOutEnabled(void) {
  * @return uint8_t The PWM freq register setting
  */
 uint8_t Adafruit_EMC2101::getPWMFrequency(void) {
-  Adafruit_BusIO_Register pwm_freq_reg =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_PWM_FREQ);
-  return pwm_freq_reg.read();
+  EMC2101_INSTRUMENT("getPWMFrequency");
+  uint8_t pwm_freq = 0xFF;
+  _readCached(EMC2101_PWM_FREQ, &pwm_freq); // includes a staged change
+  return pwm_freq;
 }
 
 /**
@@ -579,9 +2119,8 @@ uint8_t Adafruit_EMC2101::getPWMFrequency(void) {
  * @return bool true:success false:failure
  */
 bool Adafruit_EMC2101::setPWMFrequency(uint8_t pwm_freq) {
-  Adafruit_BusIO_Register pwm_freq_reg =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_PWM_FREQ);
-  return pwm_freq_reg.write(pwm_freq);
+  EMC2101_INSTRUMENT("setPWMFrequency");
+  return _updateReg(EMC2101_PWM_FREQ, 0xFF, pwm_freq);
 }
 
 /**
@@ -591,9 +2130,10 @@ bool Adafruit_EMC2101::setPWMFrequency(uint8_t pwm_freq) {
  * @return uint8_t The alternate divisor setting
  */
 uint8_t Adafruit_EMC2101::getPWMDivisor(void) {
-  Adafruit_BusIO_Register pwm_divisor_reg =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_PWM_DIV);
-  return pwm_divisor_reg.read();
+  EMC2101_INSTRUMENT("getPWMDivisor");
+  uint8_t pwm_divisor = 0xFF;
+  _readCached(EMC2101_PWM_DIV, &pwm_divisor); // includes a staged change
+  return pwm_divisor;
 }
 
 /**
@@ -603,9 +2143,8 @@ uint8_t Adafruit_EMC2101::getPWMDivisor(void) {
  * @return true:success false: failure
  */
 bool Adafruit_EMC2101::setPWMDivisor(uint8_t pwm_divisor) {
-  Adafruit_BusIO_Register pwm_divisor_reg =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_PWM_DIV);
-  return pwm_divisor_reg.write(pwm_divisor);
+  EMC2101_INSTRUMENT("setPWMDivisor");
+  return _updateReg(EMC2101_PWM_DIV, 0xFF, pwm_divisor);
 }
 
 /**
@@ -619,11 +2158,8 @@ bool Adafruit_EMC2101::setPWMDivisor(uint8_t pwm_divisor) {
  * @return true: success false: failure
  */
 bool Adafruit_EMC2101::enableForcedTemperature(bool enable_forced) {
-  Adafruit_BusIO_Register fan_config =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_FAN_CONFIG);
-  Adafruit_BusIO_RegisterBits forced_temp_en_bit =
-      Adafruit_BusIO_RegisterBits(&fan_config, 1, 6);
-  return forced_temp_en_bit.write(enable_forced);
+  EMC2101_INSTRUMENT("enableForcedTemperature");
+  return _writeField(EMC2101_FORCE_TEMP_FIELD, enable_forced);
 }
 
 /**
@@ -635,10 +2171,9 @@ bool Adafruit_EMC2101::enableForcedTemperature(bool enable_forced) {
  * @return true: success false: falure
  */
 bool Adafruit_EMC2101::setForcedTemperature(int8_t forced_temperature) {
+  EMC2101_INSTRUMENT("setForcedTemperature");
 
-  Adafruit_BusIO_Register forced_temp_reg =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_TEMP_FORCE);
-  return forced_temp_reg.write(forced_temperature);
+  return _write8(EMC2101_TEMP_FORCE, forced_temperature);
 }
 
 /**
@@ -649,8 +2184,281 @@ bool Adafruit_EMC2101::setForcedTemperature(int8_t forced_temperature) {
  * lookups
  */
 int8_t Adafruit_EMC2101::getForcedTemperature(void) {
+  EMC2101_INSTRUMENT("getForcedTemperature");
+
+  return _readReg(EMC2101_TEMP_FORCE);
+}
+
+/**
+ * @brief Apply the PWM, spin-up and minimum speed settings from a fan profile,
+ * such as one measured by `Adafruit_EMC2101_FanCharacterizer` and stored in
+ * EEPROM. Inside a transaction opened with `beginConfig` the PWM and spin-up
+ * settings are staged into it, while the minimum speed is written immediately
+ *
+ * @param profile The profile to apply
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::loadFanProfile(const emc2101_fan_profile_t *profile) {
+  EMC2101_INSTRUMENT("loadFanProfile");
+  BusGuard guard(this);
+  if (!profile) {
+    return false;
+  }
+  // stage into the caller's transaction if there is one, otherwise commit
+  // the PWM and spin-up settings together
+  bool own_txn = !_txn_open;
+  if (own_txn) {
+    beginConfig();
+  }
+  setPWMFrequency(profile->pwm_freq);
+  setPWMDivisor(profile->pwm_div);
+  configPWMClock(profile->flags & EMC2101_PROFILE_CLKSEL,
+                 profile->flags & EMC2101_PROFILE_CLKOVR);
+  configFanSpinup(profile->spinup_drive, profile->spinup_time);
+  configFanSpinup((bool)(profile->flags & EMC2101_PROFILE_TACH_SPINUP));
+  if (own_txn && !commitConfig()) {
+    return false;
+  }
+  return (profile->min_rpm == 0) || setFanMinRPM(profile->min_rpm);
+}
+
+/**
+ * @brief Set the internal temperature limit. The `EMC2101_STATUS_INT_HIGH`
+ * status bit is set when the internal temperature is above it
+ *
+ * @param high_limit The limit in degrees C
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setInternalTempHighLimit(int8_t high_limit) {
+  EMC2101_INSTRUMENT("setInternalTempHighLimit");
+  return _write8(EMC2101_INT_TEMP_HIGH_LIMIT, (uint8_t)high_limit);
+}
+
+/**
+ * @brief Get the internal temperature limit
+ *
+ * @return int8_t The limit in degrees C
+ */
+int8_t Adafruit_EMC2101::getInternalTempHighLimit(void) {
+  EMC2101_INSTRUMENT("getInternalTempHighLimit");
+  return (int8_t)_readReg(EMC2101_INT_TEMP_HIGH_LIMIT);
+}
+
+/**
+ * @brief Set the external temperature high limit. The
+ * `EMC2101_STATUS_EXT_HIGH` status bit is set when the external temperature is
+ * above it
+ *
+ * @param high_limit The limit in degrees C, with 0.125 degree resolution
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setExternalTempHighLimit(float high_limit) {
+  EMC2101_INSTRUMENT("setExternalTempHighLimit");
+  return _writeExtLimit(EMC2101_EXT_TEMP_HIGH_LIMIT_MSB,
+                        EMC2101_EXT_TEMP_HIGH_LIMIT_LSB, high_limit);
+}
+
+/**
+ * @brief Get the external temperature high limit
+ *
+ * @return float The limit in degrees C, NAN if the read failed
+ */
+float Adafruit_EMC2101::getExternalTempHighLimit(void) {
+  EMC2101_INSTRUMENT("getExternalTempHighLimit");
+  return _readExtLimit(EMC2101_EXT_TEMP_HIGH_LIMIT_MSB,
+                       EMC2101_EXT_TEMP_HIGH_LIMIT_LSB);
+}
+
+/**
+ * @brief Set the external temperature low limit. The `EMC2101_STATUS_EXT_LOW`
+ * status bit is set when the external temperature is at or below it
+ *
+ * @param low_limit The limit in degrees C, with 0.125 degree resolution
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setExternalTempLowLimit(float low_limit) {
+  EMC2101_INSTRUMENT("setExternalTempLowLimit");
+  return _writeExtLimit(EMC2101_EXT_TEMP_LOW_LIMIT_MSB,
+                        EMC2101_EXT_TEMP_LOW_LIMIT_LSB, low_limit);
+}
+
+/**
+ * @brief Get the external temperature low limit
+ *
+ * @return float The limit in degrees C, NAN if the read failed
+ */
+float Adafruit_EMC2101::getExternalTempLowLimit(void) {
+  EMC2101_INSTRUMENT("getExternalTempLowLimit");
+  return _readExtLimit(EMC2101_EXT_TEMP_LOW_LIMIT_MSB,
+                       EMC2101_EXT_TEMP_LOW_LIMIT_LSB);
+}
+
+/**
+ * @brief Set the TCRIT limit. When the external temperature is above it the
+ * `EMC2101_STATUS_TCRIT` status bit is set and the fan is driven at full speed
+ * until the temperature drops below the limit minus the TCRIT hysteresis
+ *
+ * @param tcrit_limit The limit in degrees C
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setTCritLimit(int8_t tcrit_limit) {
+  EMC2101_INSTRUMENT("setTCritLimit");
+  return _write8(EMC2101_TCRIT_LIMIT, (uint8_t)tcrit_limit);
+}
+
+/**
+ * @brief Get the TCRIT limit
+ *
+ * @return int8_t The limit in degrees C
+ */
+int8_t Adafruit_EMC2101::getTCritLimit(void) {
+  EMC2101_INSTRUMENT("getTCritLimit");
+  return (int8_t)_readReg(EMC2101_TCRIT_LIMIT);
+}
 
-  Adafruit_BusIO_Register forced_temp_reg =
-      Adafruit_BusIO_Register(i2c_dev, EMC2101_TEMP_FORCE);
-  return forced_temp_reg.read();
+/**
+ * @brief Set the hysteresis applied to the TCRIT limit
+ *
+ * @param hysteresis The hysteresis in degrees C
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setTCritHysteresis(uint8_t hysteresis) {
+  EMC2101_INSTRUMENT("setTCritHysteresis");
+  return _write8(EMC2101_TCRIT_HYSTERESIS, hysteresis);
+}
+
+/**
+ * @brief Get the hysteresis applied to the TCRIT limit
+ *
+ * @return uint8_t The hysteresis in degrees C
+ */
+uint8_t Adafruit_EMC2101::getTCritHysteresis(void) {
+  EMC2101_INSTRUMENT("getTCritHysteresis");
+  return _readReg(EMC2101_TCRIT_HYSTERESIS);
+}
+
+/**
+ * @brief Choose which conditions assert the ALERT pin. The pin must also be
+ * switched from tach input to ALERT output with `enableTachInput(false)`.
+ * The tach limit used for `EMC2101_STATUS_TACH` is set with `setFanMinRPM`.
+ *
+ * @code
+ * emc2101.enableTachInput(false);
+ * emc2101.setExternalTempHighLimit(70);
+ * emc2101.setAlertSources(EMC2101_STATUS_EXT_HIGH | EMC2101_STATUS_TCRIT);
+ * @endcode
+ *
+ * @param sources A combination of `EMC2101_STATUS_INT_HIGH`,
+ * `EMC2101_STATUS_EXT_HIGH`, `EMC2101_STATUS_EXT_LOW`, `EMC2101_STATUS_TCRIT`
+ * and `EMC2101_STATUS_TACH`, or 0 to disable the ALERT output entirely
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::setAlertSources(uint8_t sources) {
+  EMC2101_INSTRUMENT("setAlertSources");
+  BusGuard guard(this);
+  if (sources & ~EMC2101_ALERT_SOURCES) {
+    return false;
+  }
+
+  // the mask register bits line up with the status bits they mask
+  uint8_t mask;
+  if (!_read8(EMC2101_ALERT_MASK, &mask)) {
+    return false;
+  }
+  mask = (mask & ~EMC2101_ALERT_SOURCES) | (~sources & EMC2101_ALERT_SOURCES);
+  if (!_write8(EMC2101_ALERT_MASK, mask)) {
+    return false;
+  }
+
+  // MASK in the config register gates the ALERT output as a whole
+  return _writeField(EMC2101_ALERT_MASK_FIELD, (sources == 0));
+}
+
+/**
+ * @brief Read the status register. Reading it clears any latched bits whose
+ * condition is no longer present. Bits latched when `syncToConversion` read
+ * the register are included once
+ *
+ * @return uint8_t The status, a combination of `EMC2101_STATUS_*` bits, 0xFF
+ * if the read failed
+ */
+uint8_t Adafruit_EMC2101::getStatus(void) {
+  EMC2101_INSTRUMENT("getStatus");
+  BusGuard guard(this);
+  uint8_t status;
+  if (!_read8(EMC2101_STATUS, &status)) {
+    return 0xFF;
+  }
+  status |= _pending_status;
+  _pending_status = 0;
+  return status;
+}
+
+/**
+ * @brief Record that the ALERT pin was asserted. This only sets a flag, so it
+ * is safe to call from an interrupt handler:
+ * @code
+ * void onAlert(void) { emc2101.handleAlertInterrupt(); }
+ * // in setup():
+ * attachInterrupt(digitalPinToInterrupt(ALERT_PIN), onAlert, FALLING);
+ * @endcode
+ */
+void Adafruit_EMC2101::handleAlertInterrupt(void) { _alert_pending = true; }
+
+/**
+ * @brief Check if the ALERT pin was asserted since the last `serviceAlert`
+ *
+ * @return true: an alert is waiting to be serviced
+ */
+bool Adafruit_EMC2101::alertPending(void) { return _alert_pending; }
+
+/**
+ * @brief Clear the pending alert flag and read the status register to find
+ * the cause. Call this from the main loop, not the interrupt handler
+ *
+ * @return uint8_t The status, a combination of `EMC2101_STATUS_*` bits
+ */
+uint8_t Adafruit_EMC2101::serviceAlert(void) {
+  EMC2101_INSTRUMENT("serviceAlert");
+  BusGuard guard(this);
+  _alert_pending = false;
+  return getStatus();
+}
+
+/**
+ * @brief Write one of the external temperature limits
+ *
+ * @param msb_reg The register holding the whole degrees
+ * @param lsb_reg The register holding the fraction in bits 7:5
+ * @param limit The limit in degrees C
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101::_writeExtLimit(uint8_t msb_reg, uint8_t lsb_reg,
+                                      float limit) {
+  BusGuard guard(this);
+  if ((limit < -64) || (limit > 127)) {
+    return false;
+  }
+  int16_t raw_limit = (int16_t)(limit / _TEMP_LSB);
+  if (!_write8(msb_reg, (uint8_t)(raw_limit >> 3))) {
+    return false;
+  }
+  return _write8(lsb_reg, (raw_limit & 0x7) << 5);
+}
+
+/**
+ * @brief Read one of the external temperature limits
+ *
+ * @param msb_reg The register holding the whole degrees
+ * @param lsb_reg The register holding the fraction in bits 7:5
+ * @return float The limit in degrees C, NAN if the read failed
+ */
+float Adafruit_EMC2101::_readExtLimit(uint8_t msb_reg, uint8_t lsb_reg) {
+  BusGuard guard(this);
+  uint8_t buffer[2];
+  if (!_read8(msb_reg, buffer) || !_read8(lsb_reg, buffer + 1)) {
+    return NAN;
+  }
+  int16_t raw_limit = (buffer[0] << 8) | buffer[1];
+  return (raw_limit >> 5) * _TEMP_LSB;
 }
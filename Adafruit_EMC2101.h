@@ -16,10 +16,29 @@
 #ifndef _ADAFRUIT_EMC2101_H
 #define _ADAFRUIT_EMC2101_H
 
+#if defined(__linux__) && !defined(ARDUINO)
+#define EMC2101_LINUX_HOST ///< Building for a Linux host instead of Arduino
+#endif
+
+#if defined(EMC2101_LINUX_HOST)
+#include "Adafruit_EMC2101_LinuxHost.h"
+#else
 #include "Arduino.h"
 #include <Adafruit_BusIO_Register.h>
 #include <Adafruit_I2CDevice.h>
 #include <Wire.h>
+#endif
+
+#include "Adafruit_EMC2101_Instrumentation.h"
+#include "Adafruit_EMC2101_Transport.h"
+
+#if defined(__AVR__)
+#define EMC2101_MEMORY_BARRIER()                                               \
+  __asm__ __volatile__("" ::: "memory") ///< Single core, so compiler only
+#else
+#define EMC2101_MEMORY_BARRIER()                                               \
+  __sync_synchronize() ///< Full barrier for multi-core targets
+#endif
 
 #define EMC2101_I2CADDR_DEFAULT 0x4C ///< EMC2101 default i2c address
 #define EMC2101_CHIP_ID 0x16         ///< EMC2101 default device id from part id
@@ -35,9 +54,26 @@
 #define EMC2101_STATUS 0x02        ///< Status register
 #define EMC2101_REG_CONFIG 0x03    ///< configuration register
 #define EMC2101_REG_DATA_RATE 0x04 ///< Data rate config
-#define EMC2101_TEMP_FORCE 0x0C    ///< Temp force setting for LUT testing
-#define EMC2101_TACH_LSB 0x46      ///< Tach RPM data low byte
-#define EMC2101_TACH_MSB 0x47      ///< Tach RPM data high byte
+#define EMC2101_INT_TEMP_HIGH_LIMIT                                            \
+  0x05 ///< Internal temperature high limit
+#define EMC2101_EXT_TEMP_HIGH_LIMIT_MSB                                        \
+  0x07 ///< External temperature high limit high byte
+#define EMC2101_EXT_TEMP_LOW_LIMIT_MSB                                         \
+  0x08                          ///< External temperature low limit high byte
+#define EMC2101_TEMP_FORCE 0x0C ///< Temp force setting for LUT testing
+#define EMC2101_EXT_TEMP_HIGH_LIMIT_LSB                                        \
+  0x13 ///< External temperature high limit low byte
+#define EMC2101_EXT_TEMP_LOW_LIMIT_LSB                                         \
+  0x14                            ///< External temperature low limit low byte
+#define EMC2101_ALERT_MASK 0x16   ///< Per-source ALERT pin masks
+#define EMC2101_EXT_IDEALITY 0x17 ///< External diode ideality factor
+#define EMC2101_EXT_BETA_COMP                                                  \
+  0x18                           ///< External diode beta compensation
+#define EMC2101_TCRIT_LIMIT 0x19 ///< External temperature TCRIT limit
+#define EMC2101_TCRIT_HYSTERESIS                                               \
+  0x21                        ///< Hysteresis applied to the TCRIT limit
+#define EMC2101_TACH_LSB 0x46 ///< Tach RPM data low byte
+#define EMC2101_TACH_MSB 0x47 ///< Tach RPM data high byte
 #define EMC2101_TACH_LIMIT_LSB                                                 \
   0x48 ///< Tach low-speed setting low byte. INVERSE OF THE SPEED
 #define EMC2101_TACH_LIMIT_MSB                                                 \
@@ -58,8 +94,46 @@
 #define EMC2101_REG_PARTID 0xFD ///< 0x16
 #define EMC2101_REG_MFGID 0xFE  ///< 0xFF16
 
+#define EMC2101_STATUS_BUSY                                                    \
+  0x80 ///< Status: a temperature conversion is running
+#define EMC2101_STATUS_INT_HIGH                                                \
+  0x40 ///< Status: internal temperature is above its high limit
+#define EMC2101_STATUS_EEPROM 0x20 ///< Status: EEPROM load failed
+#define EMC2101_STATUS_EXT_HIGH                                                \
+  0x10 ///< Status: external temperature is above its high limit
+#define EMC2101_STATUS_EXT_LOW                                                 \
+  0x08 ///< Status: external temperature is below its low limit
+#define EMC2101_STATUS_DIODE_FAULT                                             \
+  0x04 ///< Status: the external diode is open or shorted
+#define EMC2101_STATUS_TCRIT                                                   \
+  0x02 ///< Status: external temperature is above the TCRIT limit
+#define EMC2101_STATUS_TACH                                                    \
+  0x01 ///< Status: the fan is slower than the minimum RPM setting
+
+#define EMC2101_ALERT_SOURCES                                                  \
+  (EMC2101_STATUS_INT_HIGH | EMC2101_STATUS_EXT_HIGH |                         \
+   EMC2101_STATUS_EXT_LOW | EMC2101_STATUS_TCRIT |                             \
+   EMC2101_STATUS_TACH) ///< Status bits that can be routed to the ALERT pin
+
+#define EMC2101_IDEALITY_DEFAULT                                               \
+  0x12 ///< Ideality factor setting for a 1.008 diode, the power on default
+#define EMC2101_BETA_AUTO                                                      \
+  0x08 ///< Beta compensation setting to detect the transistor's beta
+#define EMC2101_BETA_DISABLED                                                  \
+  0x07 ///< Beta compensation setting for diodes and diode-connected transistors
+
 #define MAX_LUT_SPEED 0x3F ///< 6-bit value
 #define MAX_LUT_TEMP 0x7F  ///<  7-bit
+#define EMC2101_LUT_SIZE 8 ///< Number of temperature/speed pairs in the LUT
+#define EMC2101_LUT_REGS                                                       \
+  (2 * EMC2101_LUT_SIZE) ///< Registers holding the LUT, threshold then speed
+#define EMC2101_DUTY_UNKNOWN                                                   \
+  0xFF ///< Marker for a fan setting the driver has not written
+
+#define EMC2101_TEMP_ERROR                                                     \
+  INT8_MIN ///< Internal temperature returned when the read failed
+#define EMC2101_TEMP_RAW_ERROR                                                 \
+  INT16_MIN ///< Raw external temperature returned when the read failed
 
 #define EMC2101_I2C_ADDR 0x4C ///< The default I2C address
 #define EMC2101_FAN_RPM_NUMERATOR                                              \
@@ -84,6 +158,304 @@ typedef enum {
   EMC2101_RATE_32_HZ,   ///< 32_HZ
 } emc2101_rate_t;
 
+/**
+ * @brief
+ *
+ * Allowed values for `setFilter`.
+ */
+typedef enum {
+  EMC2101_FILTER_DISABLED, ///< No filtering, the default
+  EMC2101_FILTER_LEVEL_1,  ///< Light filtering
+  EMC2101_FILTER_LEVEL_2,  ///< Heavy filtering
+} emc2101_filter_t;
+
+/**
+ * @brief Get the time between conversions for a data rate
+ *
+ * @param rate The data rate
+ * @return constexpr uint16_t The conversion period in milliseconds, rounded
+ * down
+ */
+constexpr uint16_t emc2101_rate_period_ms(emc2101_rate_t rate) {
+  return (rate > EMC2101_RATE_32_HZ) ? 0 : (16000 >> rate);
+}
+
+/**
+ * @brief Convert a raw external temperature to hundredths of a degree C
+ *
+ * @param raw The temperature in 1/8 degree C steps
+ * @return constexpr int16_t The temperature in 0.01 degree C steps
+ */
+constexpr int16_t emc2101_temp_raw_to_centi_c(int16_t raw) {
+  return (raw * 25) / 2;
+}
+
+/**
+ * @brief Convert hundredths of a degree C to a raw external temperature
+ *
+ * @param centi_c The temperature in 0.01 degree C steps
+ * @return constexpr int16_t The temperature in 1/8 degree C steps
+ */
+constexpr int16_t emc2101_centi_c_to_temp_raw(int16_t centi_c) {
+  return ((int32_t)centi_c * 2) / 25;
+}
+
+/**
+ * @brief Convert a raw tachometer count to RPM
+ *
+ * @param tach The tach count, 0xFFFF when the fan is stopped
+ * @return constexpr uint16_t The fan speed in RPM, 0 when stopped
+ */
+constexpr uint16_t emc2101_tach_to_rpm(uint16_t tach) {
+  return ((tach == 0xFFFF) || (tach == 0)) ? 0
+                                           : EMC2101_FAN_RPM_NUMERATOR / tach;
+}
+
+/**
+ * @brief Convert RPM to a raw tachometer count. Evaluate this at compile time
+ * for fixed limits and set points so the hot path can compare tach counts
+ * directly
+ *
+ * @param rpm The fan speed in RPM
+ * @return constexpr uint16_t The tach count, 0xFFFF for 0 RPM and for speeds
+ * below 83 RPM, whose counts don't fit in 16 bits
+ */
+constexpr uint16_t emc2101_rpm_to_tach(uint16_t rpm) {
+  return ((rpm == 0) || (EMC2101_FAN_RPM_NUMERATOR / rpm > 0xFFFF))
+             ? 0xFFFF
+             : EMC2101_FAN_RPM_NUMERATOR / rpm;
+}
+
+/**
+ * @brief Convert a duty cycle percentage to a raw 6-bit fan setting
+ *
+ * @param percent The duty cycle, 0-100
+ * @return constexpr uint8_t The fan setting, 0 to `MAX_LUT_SPEED`
+ */
+constexpr uint8_t emc2101_percent_to_duty_raw(uint8_t percent) {
+  return ((uint16_t)percent * MAX_LUT_SPEED) / 100;
+}
+
+/**
+ * @brief Convert a raw 6-bit fan setting to a duty cycle percentage
+ *
+ * @param raw The fan setting, 0 to `MAX_LUT_SPEED`
+ * @return constexpr uint8_t The duty cycle, 0-100
+ */
+constexpr uint8_t emc2101_duty_raw_to_percent(uint8_t raw) {
+  return ((uint16_t)raw * 100) / MAX_LUT_SPEED;
+}
+
+/**
+ * @brief A bit field within one 8-bit register, with its mask and shift
+ * worked out at compile time. Fields are used as empty constant objects so
+ * the driver's field helpers can deduce them:
+ * @code
+ * _writeField(EMC2101_LUT_DISABLE_FIELD, 1);
+ * @endcode
+ *
+ * @tparam REG The register address
+ * @tparam SHIFT The position of the field's lowest bit
+ * @tparam WIDTH The number of bits in the field
+ */
+template <uint8_t REG, uint8_t SHIFT, uint8_t WIDTH>
+struct Adafruit_EMC2101_Field {
+  static_assert((WIDTH >= 1) && (SHIFT + WIDTH <= 8),
+                "field must fit in one 8-bit register");
+
+  static constexpr uint8_t reg = REG;                    ///< Register address
+  static constexpr uint8_t max_value = (1 << WIDTH) - 1; ///< Largest value
+  static constexpr uint8_t mask = max_value << SHIFT;    ///< Field bits
+
+  /**
+   * @brief Extract the field from a register value
+   *
+   * @param reg_value The whole register
+   * @return constexpr uint8_t The field value
+   */
+  static constexpr uint8_t get(uint8_t reg_value) {
+    return (reg_value >> SHIFT) & max_value;
+  }
+
+  /**
+   * @brief Position a field value within the register, dropping bits that
+   * don't fit
+   *
+   * @param value The field value
+   * @return constexpr uint8_t The value shifted into the field's bits
+   */
+  static constexpr uint8_t bits(uint8_t value) {
+    return (uint8_t)(value << SHIFT) & mask;
+  }
+};
+
+constexpr Adafruit_EMC2101_Field<EMC2101_REG_CONFIG, 7, 1>
+    EMC2101_ALERT_MASK_FIELD{}; ///< Masks the ALERT pin for all sources
+constexpr Adafruit_EMC2101_Field<EMC2101_REG_CONFIG, 4, 1>
+    EMC2101_DAC_FIELD{}; ///< DAC rather than PWM fan output
+constexpr Adafruit_EMC2101_Field<EMC2101_REG_CONFIG, 2, 1>
+    EMC2101_TACH_INPUT_FIELD{}; ///< TACH/ALERT pin is a tach input
+constexpr Adafruit_EMC2101_Field<EMC2101_REG_DATA_RATE, 0, 4>
+    EMC2101_DATA_RATE_FIELD{}; ///< Conversion rate, a `emc2101_rate_t`
+constexpr Adafruit_EMC2101_Field<EMC2101_EXT_IDEALITY, 0, 6>
+    EMC2101_IDEALITY_FIELD{}; ///< External diode ideality factor setting
+constexpr Adafruit_EMC2101_Field<EMC2101_EXT_BETA_COMP, 0, 4>
+    EMC2101_BETA_FIELD{}; ///< Beta compensation setting, including auto
+constexpr Adafruit_EMC2101_Field<EMC2101_FAN_CONFIG, 6, 1>
+    EMC2101_FORCE_TEMP_FIELD{}; ///< Use the forced temperature for the LUT
+constexpr Adafruit_EMC2101_Field<EMC2101_FAN_CONFIG, 5, 1>
+    EMC2101_LUT_DISABLE_FIELD{}; ///< Disables the LUT, allowing manual control
+constexpr Adafruit_EMC2101_Field<EMC2101_FAN_CONFIG, 4, 1>
+    EMC2101_POLARITY_FIELD{}; ///< Inverts the fan output
+constexpr Adafruit_EMC2101_Field<EMC2101_FAN_CONFIG, 3, 1>
+    EMC2101_CLK_SEL_FIELD{}; ///< Selects the 1.4kHz base PWM clock
+constexpr Adafruit_EMC2101_Field<EMC2101_FAN_CONFIG, 2, 1>
+    EMC2101_CLK_OVR_FIELD{}; ///< Uses the PWM divisor to set the frequency
+constexpr Adafruit_EMC2101_Field<EMC2101_FAN_SPINUP, 5, 1>
+    EMC2101_SPINUP_TACH_FIELD{}; ///< Spin up until the tach reaches the minimum
+constexpr Adafruit_EMC2101_Field<EMC2101_FAN_SPINUP, 3, 2>
+    EMC2101_SPINUP_DRIVE_FIELD{}; ///< Spin-up drive strength
+constexpr Adafruit_EMC2101_Field<EMC2101_FAN_SPINUP, 0, 3>
+    EMC2101_SPINUP_TIME_FIELD{}; ///< Spin-up time
+constexpr Adafruit_EMC2101_Field<EMC2101_TEMP_FILTER, 1, 2>
+    EMC2101_FILTER_FIELD{}; ///< Digital filter level, a `emc2101_filter_t`
+
+static_assert(EMC2101_RATE_32_HZ <= EMC2101_DATA_RATE_FIELD.max_value,
+              "data rates must fit the data rate field");
+static_assert(EMC2101_FILTER_LEVEL_2 <= EMC2101_FILTER_FIELD.max_value,
+              "filter levels must fit the filter field");
+static_assert(EMC2101_BETA_AUTO <= EMC2101_BETA_FIELD.max_value,
+              "beta settings must fit the beta field");
+static_assert(EMC2101_IDEALITY_DEFAULT <= EMC2101_IDEALITY_FIELD.max_value,
+              "the default ideality must fit the ideality field");
+
+/**
+ * @brief A single temperature threshold to fan speed mapping for the LUT
+ */
+typedef struct {
+  uint8_t temp_thresh; ///< Temperature threshold in degrees C, up to 127
+  uint8_t fan_pwm;     ///< Fan duty cycle percentage, 0-100
+} emc2101_lut_entry_t;
+
+#define EMC2101_PROFILE_POINTS                                                 \
+  9 ///< Duty cycle steps in a fan profile's transfer curve
+#define EMC2101_PROFILE_CLKSEL 0x01 ///< Fan profile flag for `configPWMClock`
+#define EMC2101_PROFILE_CLKOVR 0x02 ///< Fan profile flag for `configPWMClock`
+#define EMC2101_PROFILE_TACH_SPINUP                                            \
+  0x04 ///< Fan profile flag for `configFanSpinup(true)`
+
+/**
+ * @brief The measured behavior of a fan and the settings chosen for it, as
+ * filled by `Adafruit_EMC2101_FanCharacterizer` and applied with
+ * `loadFanProfile`
+ */
+typedef struct {
+  uint8_t pwm_freq;       ///< `setPWMFrequency` setting
+  uint8_t pwm_div;        ///< `setPWMDivisor` setting
+  uint8_t flags;          ///< `EMC2101_PROFILE_*` flags
+  uint8_t spinup_drive;   ///< `configFanSpinup` drive setting, 0-3
+  uint8_t spinup_time;    ///< `configFanSpinup` time setting, 0-7
+  uint8_t min_duty_raw;   ///< Lowest fan setting that keeps the fan turning
+  uint8_t start_duty_raw; ///< Lowest fan setting that starts a stopped fan
+  uint16_t min_rpm;   ///< `setFanMinRPM` setting, below the min_duty_raw speed
+  uint16_t spinup_ms; ///< Measured time to start from a stop
+  uint16_t rpm[EMC2101_PROFILE_POINTS]; ///< Speed at fan settings 0, 8, ..63
+} emc2101_fan_profile_t;
+
+/**
+ * @brief The values gathered by `readSnapshot`, both raw and converted
+ */
+typedef struct {
+  int8_t internal_temp;      ///< Internal temperature in degrees C
+  int16_t external_temp_raw; ///< External temperature in 1/8 degree C steps
+  float external_temp;       ///< External temperature in degrees C
+  uint16_t tach_raw;         ///< Raw tachometer count, 0xFFFF when stopped
+  uint16_t fan_rpm;          ///< Fan speed in RPM, 0 when stopped
+  uint8_t duty_raw;          ///< Raw 6-bit fan setting
+  uint8_t duty_cycle;        ///< Fan setting as a duty cycle percentage
+  uint8_t status;            ///< Status register, see `EMC2101_STATUS_*`
+} emc2101_snapshot_t;
+
+/**
+ * @brief Function called by `poll()` when a snapshot started with
+ * `startSnapshot` is complete
+ */
+typedef void (*emc2101_snapshot_callback_t)(emc2101_snapshot_t *snapshot);
+
+/**
+ * @brief
+ *
+ * Values returned by `poll`.
+ */
+typedef enum {
+  EMC2101_ASYNC_IDLE,        ///< No snapshot read has been started
+  EMC2101_ASYNC_IN_PROGRESS, ///< More register reads are needed
+  EMC2101_ASYNC_DONE,        ///< The snapshot was completed by this call
+  EMC2101_ASYNC_ERROR,       ///< A read failed and the snapshot was abandoned
+} emc2101_async_status_t;
+
+/**
+ * @brief
+ *
+ * Values returned by `lastError`.
+ */
+typedef enum {
+  EMC2101_OK,                ///< No transfer has failed
+  EMC2101_ERROR_NOT_STARTED, ///< `begin` has not been called
+  EMC2101_ERROR_READ,        ///< A register read failed after all retries
+  EMC2101_ERROR_WRITE,       ///< A register write failed after all retries
+} emc2101_error_t;
+
+#define EMC2101_BUS_READ_BYTES                                                 \
+  4 ///< Bytes on the bus for a register read: address, register, address, data
+#define EMC2101_BUS_WRITE_BYTES                                                \
+  3 ///< Bytes on the bus for a register write: address, register, data
+
+/**
+ * @brief Bus transfer counters kept by each driver instance, see
+ * `getBusStats`
+ */
+typedef struct {
+  uint32_t transfers;  ///< Register reads and writes
+  uint32_t bytes;      ///< Bytes on the bus, with addresses and retries
+  uint32_t errors;     ///< Transfers that failed after all retries
+  uint32_t retries;    ///< Extra attempts made after a failed transfer
+  uint32_t recoveries; ///< Calls to the bus recovery function
+  uint32_t total_us;   ///< Time spent in transfers, including retries
+  uint32_t max_us;     ///< Longest single transfer, including retries
+} emc2101_bus_stats_t;
+
+/**
+ * @brief Function called before the last retry of a failed transfer, to free
+ * a stuck bus by clocking out SCL or resetting the I2C peripheral
+ */
+typedef void (*emc2101_bus_recovery_t)(void);
+
+/**
+ * @brief Function that takes or releases the lock for a bus, given the
+ * context pointer passed to `setBusLock`
+ */
+typedef void (*emc2101_lock_fn_t)(void *context);
+
+#define EMC2101_SEQLOCK_TRIES                                                  \
+  16 ///< Attempts `getPublishedSnapshot` makes before giving up
+
+#define EMC2101_SNAPSHOT_STEPS 7 ///< Register reads needed for a snapshot
+
+#define EMC2101_CONFIG_VERSION 2 ///< Format version of saved configurations
+#define EMC2101_CONFIG_REG_COUNT                                               \
+  38 ///< Registers stored in a saved configuration
+#define EMC2101_CONFIG_SIZE                                                    \
+  (EMC2101_CONFIG_REG_COUNT + 2) ///< Bytes in a saved configuration
+
+#define EMC2101_TXN_REGS 5 ///< Registers a configuration transaction covers
+
+#define EMC2101_TXN_PWM_DIV 0x01    ///< `commitConfig` wrote EMC2101_PWM_DIV
+#define EMC2101_TXN_PWM_FREQ 0x02   ///< `commitConfig` wrote EMC2101_PWM_FREQ
+#define EMC2101_TXN_FAN_SPINUP 0x04 ///< `commitConfig` wrote EMC2101_FAN_SPINUP
+#define EMC2101_TXN_REG_CONFIG 0x08 ///< `commitConfig` wrote EMC2101_REG_CONFIG
+#define EMC2101_TXN_FAN_CONFIG 0x10 ///< `commitConfig` wrote EMC2101_FAN_CONFIG
+
 /*!
  *    @brief  Class that stores state and functions for interacting with
  *            the EMC2101 Temperature monitor and fan controller
@@ -93,7 +465,40 @@ public:
   Adafruit_EMC2101();
   ~Adafruit_EMC2101();
 
-  bool begin(uint8_t i2c_addr = EMC2101_I2CADDR_DEFAULT, TwoWire *wire = &Wire);
+#if !defined(EMC2101_LINUX_HOST)
+  bool begin(uint8_t i2c_addr = EMC2101_I2CADDR_DEFAULT, TwoWire *wire = &Wire,
+             const uint8_t *config = NULL);
+  bool begin(Adafruit_I2CDevice *i2c_device, const uint8_t *config = NULL);
+#endif
+  bool begin(Adafruit_EMC2101_Transport *transport,
+             const uint8_t *config = NULL);
+
+  // Error handling:
+  emc2101_error_t lastError(void);
+  void clearError(void);
+  void setRetries(uint8_t retries, uint16_t backoff_us = 50);
+  void setBusRecovery(emc2101_bus_recovery_t recovery);
+  void getBusStats(emc2101_bus_stats_t *stats);
+  void resetBusStats(void);
+
+  // Multi-core and multi-task access:
+  void setBusLock(emc2101_lock_fn_t lock, emc2101_lock_fn_t unlock,
+                  void *context);
+  bool getPublishedSnapshot(emc2101_snapshot_t *out);
+
+  // Saved configurations:
+  bool saveConfig(uint8_t *config);
+  bool restoreConfig(const uint8_t *config);
+  static bool configValid(const uint8_t *config);
+
+  // Configuration transactions:
+  void beginConfig(void);
+  bool commitConfig(uint8_t *changed = NULL);
+  void cancelConfig(void);
+
+  // Configuration register cache:
+  bool enableRegisterCache(bool enable_cache);
+  bool resync(void);
 
   // Enable/disable & status functions:
   bool LUTEnabled(void);
@@ -104,11 +509,23 @@ public:
 
   // Accessors:
   float getExternalTemperature(void);
+  int16_t getExternalTemperatureRaw(void);
   int8_t getInternalTemperature(void);
   uint16_t getFanRPM(void);
+  uint16_t getFanTachRaw(void);
+  bool getFanTachRaw(uint16_t *tach);
+  bool readSnapshot(emc2101_snapshot_t *out);
+  bool startSnapshot(emc2101_snapshot_t *out,
+                     emc2101_snapshot_callback_t callback = NULL);
+  emc2101_async_status_t poll(void);
+  bool cancelSnapshot(void);
 
   uint8_t getDutyCycle(void);
+  uint8_t getDutyCycleRaw(void);
   bool setDutyCycle(uint8_t pwm_duty_cycle);
+  bool setDutyCycleRaw(uint8_t raw_duty_cycle);
+  void beginDutyCycleBatch(void);
+  bool endDutyCycleBatch(void);
 
   uint16_t getFanMinRPM(void);
   bool setFanMinRPM(uint16_t min_rpm);
@@ -116,7 +533,26 @@ public:
   emc2101_rate_t getDataRate(void);
   bool setDataRate(emc2101_rate_t data_rate);
 
+  // External diode configuration:
+  emc2101_filter_t getFilter(void);
+  bool setFilter(emc2101_filter_t filter);
+  uint8_t getIdealityFactor(void);
+  bool setIdealityFactor(uint8_t ideality);
+  uint8_t getBetaCompensation(void);
+  bool setBetaCompensation(uint8_t beta);
+
+  // Conversion-aware reads:
+  bool enableConversionTracking(bool enable_tracking);
+  bool syncToConversion(uint32_t timeout_ms = 100);
+  uint32_t msUntilNextConversion(void);
+  void waitForConversion(void);
+  uint32_t staleReadCount(void);
+
   bool setLUT(uint8_t index, uint8_t temp_thresh, uint8_t fan_pwm);
+  bool setLUT(const emc2101_lut_entry_t *entries, uint8_t count);
+  bool swapLUT(const emc2101_lut_entry_t *entries, uint8_t count,
+               uint8_t safe_duty_raw = MAX_LUT_SPEED,
+               uint32_t timeout_ms = 500);
 
   uint8_t getPWMFrequency(void);
   bool setPWMFrequency(uint8_t pwm_freq);
@@ -139,10 +575,181 @@ public:
   bool enableTachInput(bool tach_enable);
   bool invertFanSpeed(bool invert_speed);
 
+  bool loadFanProfile(const emc2101_fan_profile_t *profile);
+
+  // Limits and ALERT handling:
+  bool setInternalTempHighLimit(int8_t high_limit);
+  int8_t getInternalTempHighLimit(void);
+  bool setExternalTempHighLimit(float high_limit);
+  float getExternalTempHighLimit(void);
+  bool setExternalTempLowLimit(float low_limit);
+  float getExternalTempLowLimit(void);
+  bool setTCritLimit(int8_t tcrit_limit);
+  int8_t getTCritLimit(void);
+  bool setTCritHysteresis(uint8_t hysteresis);
+  uint8_t getTCritHysteresis(void);
+
+  bool setAlertSources(uint8_t sources);
+  uint8_t getStatus(void);
+
+  void handleAlertInterrupt(void);
+  bool alertPending(void);
+  uint8_t serviceAlert(void);
+
 private:
-  bool _init(void);
+  /*!
+   *    @brief  Holds the bus lock set with `setBusLock`, if any, for as long
+   *            as it is in scope
+   */
+  class BusGuard {
+  public:
+    BusGuard(Adafruit_EMC2101 *emc2101);
+    ~BusGuard();
+
+  private:
+    Adafruit_EMC2101 *_emc2101; ///< The driver whose lock is held
+  };
+
+  bool _init(const uint8_t *config = NULL);
+#if !defined(EMC2101_LINUX_HOST)
+  bool _beginBusIO(const uint8_t *config);
+#endif
+  void _publish(const emc2101_snapshot_t *snapshot);
+  static uint8_t _crc8(const uint8_t *data, uint8_t len);
+  uint32_t _nextConversion(uint32_t now_ms);
+  void _dataRateChanged(emc2101_rate_t data_rate);
+
+  bool _transfer(uint8_t reg_addr, uint8_t *value, bool read);
+  bool _read8(uint8_t reg_addr, uint8_t *value);
+  bool _write8(uint8_t reg_addr, uint8_t value);
+  uint8_t _readReg(uint8_t reg_addr);
+  bool _writeExtLimit(uint8_t msb_reg, uint8_t lsb_reg, float limit);
+  float _readExtLimit(uint8_t msb_reg, uint8_t lsb_reg);
+  void _fillSnapshot(const uint8_t *buffer, emc2101_snapshot_t *out);
+  bool _finishInterlock(void);
+  bool _writeLUTEntry(uint8_t index, uint8_t temp_thresh, uint8_t fan_pwm);
+  static bool _buildLUT(const emc2101_lut_entry_t *entries, uint8_t count,
+                        uint8_t *regs);
+  bool _writeLUTRegs(const uint8_t *regs);
+  bool _verifyLUT(const uint8_t *regs, uint8_t count, uint32_t timeout_ms);
+  uint8_t *_shadowFor(uint8_t reg_addr);
+  bool _readCached(uint8_t reg_addr, uint8_t *value);
+  int8_t _txnIndex(uint8_t reg_addr);
+  bool _updateReg(uint8_t reg_addr, uint8_t mask, uint8_t bits);
+
+  /**
+   * @brief Read a register field, using the shadow cache if possible
+   *
+   * @param field The field, such as `EMC2101_LUT_DISABLE_FIELD`
+   * @param value Where to store the field value. Unchanged on failure
+   * @return true: success false: failure
+   */
+  template <class F> bool _readField(F field, uint8_t *value) {
+    uint8_t reg_value;
+    if (!_readCached(field.reg, &reg_value)) {
+      return false;
+    }
+    *value = field.get(reg_value);
+    return true;
+  }
+
+  /**
+   * @brief Read a register field for accessors that return it directly
+   *
+   * @param field The field
+   * @return uint8_t The field value, all ones if the read failed
+   */
+  template <class F> uint8_t _readField(F field) {
+    uint8_t value = field.max_value;
+    _readField(field, &value);
+    return value;
+  }
 
+  /**
+   * @brief Write a register field. Cached registers are updated with a
+   * single write, others with a read-modify-write
+   *
+   * @param field The field
+   * @param value The new field value. Bits that don't fit are dropped
+   * @return true: success false: failure
+   */
+  template <class F> bool _writeField(F field, uint8_t value) {
+    return _updateReg(field.reg, field.mask, field.bits(value));
+  }
+
+  /**
+   * @brief Write two fields of the same register with a single update
+   *
+   * @param field1 The first field
+   * @param value1 The first field's new value
+   * @param field2 The second field, in the same register
+   * @param value2 The second field's new value
+   * @return true: success false: failure
+   */
+  template <class F1, class F2>
+  bool _writeFields(F1 field1, uint8_t value1, F2 field2, uint8_t value2) {
+    static_assert(F1::reg == F2::reg, "fields must be in the same register");
+    static_assert((F1::mask & F2::mask) == 0, "fields must not overlap");
+    return _updateReg(F1::reg, F1::mask | F2::mask,
+                      field1.bits(value1) | field2.bits(value2));
+  }
+
+  Adafruit_EMC2101_Transport *_transport = NULL; ///< All bus access goes here
+#if !defined(EMC2101_LINUX_HOST)
   Adafruit_I2CDevice *i2c_dev = NULL; ///< Pointer to I2C bus interface
+  bool _owns_i2c_dev = false;         ///< `i2c_dev` was allocated by `begin`
+  TwoWire *_wire = NULL;              ///< The bus `i2c_dev` was allocated for
+  Adafruit_EMC2101_BusIOTransport _busio; ///< Transport for `i2c_dev`
+#endif
+
+  emc2101_error_t _last_error = EMC2101_OK; ///< First error since clearError
+  uint8_t _retries = 2;            ///< Extra attempts for a failed transfer
+  uint16_t _retry_backoff_us = 50; ///< Delay before the first retry
+  emc2101_bus_recovery_t _bus_recovery = NULL; ///< Called before last retry
+  emc2101_bus_stats_t _bus_stats = {};         ///< Transfer counters
+
+  emc2101_lock_fn_t _lock_fn = NULL;    ///< Takes the bus lock
+  emc2101_lock_fn_t _unlock_fn = NULL;  ///< Releases the bus lock
+  void *_lock_context = NULL;           ///< Passed to the lock functions
+  volatile uint32_t _published_seq = 0; ///< Odd while publishing, 0 if never
+  emc2101_snapshot_t _published;        ///< Last snapshot read
+
+  bool _cache_enabled = false;    ///< Use the shadow register cache
+  uint8_t _fan_config_shadow = 0; ///< Cached EMC2101_FAN_CONFIG value
+  uint8_t _reg_config_shadow = 0; ///< Cached EMC2101_REG_CONFIG value
+  uint8_t _fan_spinup_shadow = 0; ///< Cached EMC2101_FAN_SPINUP value
+
+  bool _lut_known_disabled = false; ///< This driver last disabled the LUT
+  uint8_t _last_duty_raw = EMC2101_DUTY_UNKNOWN; ///< Last fan setting written
+  bool _duty_batch_open = false;    ///< Duty cycle writes are being batched
+  bool _duty_batch_pending = false; ///< A batched duty cycle is waiting
+  uint8_t _duty_batch_value = 0;    ///< The batched raw duty cycle
+
+  static const uint8_t _txn_regs[EMC2101_TXN_REGS];
+  bool _txn_open = false;              ///< Configuration writes are staged
+  uint8_t _txn_mask[EMC2101_TXN_REGS]; ///< Staged bits of each register
+  uint8_t _txn_bits[EMC2101_TXN_REGS]; ///< Staged values of those bits
+
+  static const uint8_t _config_regs[EMC2101_CONFIG_REG_COUNT];
+  static const uint8_t _snapshot_regs[EMC2101_SNAPSHOT_STEPS];
+  emc2101_snapshot_t *_async_out = NULL; ///< Snapshot being read by `poll()`
+  emc2101_snapshot_callback_t _async_callback = NULL; ///< Completion callback
+  uint8_t _async_step = 0; ///< Next `_snapshot_regs` entry to read
+  uint8_t _async_buffer[EMC2101_SNAPSHOT_STEPS]; ///< Registers read so far
+
+  volatile bool _alert_pending = false; ///< Set by `handleAlertInterrupt`
+  uint8_t _pending_status = 0;          ///< Bits kept by `syncToConversion`
+
+  bool _track_conversions = false; ///< Serve cached temps between conversions
+  uint16_t _conversion_period_ms = 0; ///< Period at the current data rate
+  uint32_t _conversion_epoch_ms = 0;  ///< A known conversion boundary
+  uint32_t _stale_reads = 0;          ///< Reads answered from the cache
+  bool _int_temp_valid = false;       ///< `_int_temp_cache` holds a reading
+  bool _ext_temp_valid = false;       ///< `_ext_temp_cache` holds a reading
+  int8_t _int_temp_cache = 0;         ///< Last internal temperature read
+  int16_t _ext_temp_cache = 0;        ///< Last raw external temperature read
+  uint32_t _int_temp_next_ms = 0;     ///< When a new internal temp is due
+  uint32_t _ext_temp_next_ms = 0;     ///< When a new external temp is due
 };
 
 #endif
@@ -0,0 +1,202 @@
+/*!
+ *  @file Adafruit_EMC2101_Curve.cpp
+ *
+ * 	Temperature to fan speed curve engine for the EMC2101, with finer steps
+ * than the chip's 8 entry look up table
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_Curve.h"
+
+/**
+ * @brief Construct a new Adafruit_EMC2101_Curve
+ *
+ * @param emc2101 The fan controller to drive. It must already be started
+ * with `begin()`
+ */
+Adafruit_EMC2101_Curve::Adafruit_EMC2101_Curve(Adafruit_EMC2101 *emc2101) {
+  _emc2101 = emc2101;
+}
+
+/**
+ * @brief Set the curve and precompute its table, with one raw duty cycle
+ * value per whole degree between the first and last points
+ *
+ * @param points The points on the curve, in order of strictly increasing
+ * temperature. Below the first point and above the last the curve is flat
+ * @param count The number of points, at least 1. The temperature span of the
+ * curve must be less than `EMC2101_CURVE_TABLE_SIZE` degrees
+ * @return true: success false: invalid curve
+ */
+bool Adafruit_EMC2101_Curve::setCurve(const emc2101_curve_point_t *points,
+                                      uint8_t count) {
+  if (!points || (count == 0)) {
+    return false;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    if (points[i].fan_pwm > 100) {
+      return false;
+    }
+    if ((i > 0) && (points[i].temp <= points[i - 1].temp)) {
+      return false;
+    }
+  }
+  int16_t span = points[count - 1].temp - points[0].temp;
+  if (span >= EMC2101_CURVE_TABLE_SIZE) {
+    return false;
+  }
+
+  _table_start = points[0].temp;
+  _table_len = span + 1;
+  uint8_t segment = 0;
+  for (uint8_t i = 0; i < _table_len; i++) {
+    int16_t temp = _table_start + i;
+    while ((segment + 1 < count) && (temp > points[segment + 1].temp)) {
+      segment++;
+    }
+    const emc2101_curve_point_t *lo = &points[segment];
+    const emc2101_curve_point_t *hi =
+        &points[(segment + 1 < count) ? segment + 1 : segment];
+
+    // interpolate in raw duty steps, rounding to the nearest step
+    int32_t lo_duty = (int32_t)lo->fan_pwm * MAX_LUT_SPEED;
+    int32_t hi_duty = (int32_t)hi->fan_pwm * MAX_LUT_SPEED;
+    int32_t duty = lo_duty;
+    if (hi->temp != lo->temp) {
+      duty += (hi_duty - lo_duty) * (temp - lo->temp) / (hi->temp - lo->temp);
+    }
+    _table[i] = (duty + 50) / 100;
+  }
+  return true;
+}
+
+/**
+ * @brief Look up the fan setting for a temperature, interpolating between the
+ * table's whole degree entries with integer math
+ *
+ * @param temp_raw The temperature in 1/8 degree C steps, as returned by
+ * `getExternalTemperatureRaw`
+ * @return uint8_t The raw duty cycle, 0 to `MAX_LUT_SPEED`. Full speed if
+ * `temp_raw` is `EMC2101_TEMP_RAW_ERROR`
+ */
+uint8_t Adafruit_EMC2101_Curve::evaluate(int16_t temp_raw) {
+  if ((_table_len == 0) || (temp_raw == EMC2101_TEMP_RAW_ERROR)) {
+    return MAX_LUT_SPEED; // no curve or no reading, fail safe
+  }
+  int16_t offset = temp_raw - ((int16_t)_table_start << 3);
+  if (offset <= 0) {
+    return _table[0];
+  }
+  uint8_t index = offset >> 3;
+  if (index >= _table_len - 1) {
+    return _table[_table_len - 1];
+  }
+  uint8_t frac = offset & 0x7;
+  int16_t lo = _table[index];
+  int16_t hi = _table[index + 1];
+  return lo + (((hi - lo) * frac + 4) >> 3);
+}
+
+/**
+ * @brief Read the external temperature and apply the curve. The fan setting
+ * is only written when it changes
+ *
+ * @return true: success false: failure. The fan is set to full speed if the
+ * temperature could not be read
+ */
+bool Adafruit_EMC2101_Curve::update(void) {
+  int16_t temp_raw = _emc2101->getExternalTemperatureRaw();
+  bool success = update(temp_raw);
+  return success && (temp_raw != EMC2101_TEMP_RAW_ERROR);
+}
+
+/**
+ * @brief Apply the curve for a temperature measured elsewhere, such as from
+ * `readSnapshot`. The fan setting is only written when it changes
+ *
+ * @param temp_raw The temperature in 1/8 degree C steps
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_Curve::update(int16_t temp_raw) {
+  return _emc2101->setDutyCycleRaw(evaluate(temp_raw));
+}
+
+/**
+ * @brief Approximate the curve with the chip's 8 entry look up table.
+ *
+ * The curve's span is split into 8 equal steps, and each step uses the highest
+ * fan speed the curve reaches within it, including the fractions of a degree
+ * just below the next step. The first step starts at 0 degrees,
+ * since the chip stops the fan below the first threshold while the curve stays
+ * at its first point's speed, and steps clipped to the same threshold are
+ * merged. The approximation never cools less than the curve would from 0 to
+ * `MAX_LUT_TEMP` degrees; below 0 degrees the chip stops the fan.
+ *
+ * @param entries Array of `EMC2101_LUT_SIZE` entries to fill, ready for
+ * `setLUT`
+ * @return uint8_t The number of entries filled, 0 if there is no curve.
+ * Curves spanning less than 8 degrees use fewer entries, and temperatures are
+ * limited to the LUT's 0 to `MAX_LUT_TEMP` range
+ */
+uint8_t Adafruit_EMC2101_Curve::compileHardwareLUT(
+    emc2101_lut_entry_t *entries) {
+  if (!entries || (_table_len == 0)) {
+    return 0;
+  }
+  uint8_t steps = (_table_len < EMC2101_LUT_SIZE) ? _table_len
+                                                  : EMC2101_LUT_SIZE;
+  uint8_t count = 0;
+  int16_t last_thresh = -1;
+  uint8_t last_duty = 0;
+  for (uint8_t k = 0; k < steps; k++) {
+    uint8_t start = ((uint16_t)k * _table_len) / steps;
+    uint8_t end = ((uint16_t)(k + 1) * _table_len) / steps;
+    int16_t thresh = constrain(_table_start + start, 0, MAX_LUT_TEMP);
+    if (k == 0) {
+      thresh = 0; // cover the flat part of the curve below its first point
+    }
+
+    // temperatures just below `end` interpolate towards `_table[end]`
+    uint8_t last = (end < _table_len) ? end : _table_len - 1;
+    uint8_t duty = 0;
+    for (uint8_t i = start; i <= last; i++) {
+      duty = max(duty, _table[i]);
+    }
+    if (thresh <= last_thresh) {
+      // clipped to the same threshold as the previous step, so share it
+      count--;
+      duty = max(duty, last_duty);
+    }
+    entries[count].temp_thresh = thresh;
+    // round up, so `setLUT`'s conversion back to raw never lowers the speed
+    entries[count].fan_pwm =
+        ((uint16_t)duty * 100 + MAX_LUT_SPEED - 1) / MAX_LUT_SPEED;
+    last_thresh = thresh;
+    last_duty = duty;
+    count++;
+  }
+  return count;
+}
+
+/**
+ * @brief Program the chip's look up table with `compileHardwareLUT`.
+ *
+ * The LUT is only written, not enabled, so the host keeps control of the fan.
+ * A watchdog or recovery path can then call `LUTEnabled(true)` to hand the fan
+ * to a close match of the curve without reprogramming anything.
+ *
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_Curve::pushHardwareLUT(void) {
+  emc2101_lut_entry_t entries[EMC2101_LUT_SIZE];
+  uint8_t count = compileHardwareLUT(entries);
+  if (count == 0) {
+    return false;
+  }
+  return _emc2101->setLUT(entries, count);
+}
@@ -0,0 +1,57 @@
+/*!
+ *  @file Adafruit_EMC2101_Curve.h
+ *
+ * 	Temperature to fan speed curve engine for the EMC2101, with finer steps
+ *than the chip's 8 entry look up table
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_EMC2101_CURVE_H
+#define _ADAFRUIT_EMC2101_CURVE_H
+
+#include "Adafruit_EMC2101.h"
+
+#ifndef EMC2101_CURVE_TABLE_SIZE
+#define EMC2101_CURVE_TABLE_SIZE                                               \
+  128 ///< Most whole degrees a curve's precomputed table can cover
+#endif
+
+/**
+ * @brief A point on a temperature to fan speed curve
+ */
+typedef struct {
+  int8_t temp;     ///< Temperature in degrees C
+  uint8_t fan_pwm; ///< Fan duty cycle percentage at `temp`, 0-100
+} emc2101_curve_point_t;
+
+/*!
+ *    @brief  Class that evaluates a piecewise-linear temperature to fan speed
+ *            curve on the host and applies it to an EMC2101
+ */
+class Adafruit_EMC2101_Curve {
+public:
+  Adafruit_EMC2101_Curve(Adafruit_EMC2101 *emc2101);
+
+  bool setCurve(const emc2101_curve_point_t *points, uint8_t count);
+  uint8_t evaluate(int16_t temp_raw);
+  bool update(void);
+  bool update(int16_t temp_raw);
+
+  uint8_t compileHardwareLUT(emc2101_lut_entry_t *entries);
+  bool pushHardwareLUT(void);
+
+private:
+  Adafruit_EMC2101 *_emc2101; ///< The fan controller being driven
+
+  uint8_t _table[EMC2101_CURVE_TABLE_SIZE]; ///< Raw duty cycle per degree
+  uint8_t _table_len = 0;                   ///< Entries used in `_table`
+  int8_t _table_start = 0; ///< Temperature of `_table[0]` in degrees C
+};
+
+#endif
@@ -0,0 +1,275 @@
+/*!
+ *  @file Adafruit_EMC2101_FanCharacterizer.cpp
+ *
+ * 	Measures how a fan attached to an EMC2101 responds to the fan setting, and
+ * chooses PWM and spin-up settings for it
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_FanCharacterizer.h"
+
+#define SAMPLES_PER_READING 4 ///< Tach readings averaged per measurement
+
+/**
+ * @brief The PWM clock settings tried, from the ~25kHz used by 4-wire fans to
+ * the low frequencies suited to switching the supply of 3-wire fans
+ */
+const Adafruit_EMC2101_FanCharacterizer::pwm_candidate_t
+    Adafruit_EMC2101_FanCharacterizer::_pwm_candidates[] = {
+        {0x07, 0x01, 0},                      // 360kHz / 14: ~25.7kHz
+        {0x1F, 0x01, 0},                      // 360kHz / 62: ~5.8kHz
+        {0x1F, 0x01, EMC2101_PROFILE_CLKSEL}, // 1.4kHz / 62: ~22.6Hz
+};
+
+/**
+ * @brief Construct a new Adafruit_EMC2101_FanCharacterizer
+ *
+ * @param emc2101 The fan controller the fan is attached to. It must already be
+ * started with `begin()`
+ */
+Adafruit_EMC2101_FanCharacterizer::Adafruit_EMC2101_FanCharacterizer(
+    Adafruit_EMC2101 *emc2101) {
+  _emc2101 = emc2101;
+}
+
+/**
+ * @brief Measure the attached fan and fill a profile for it.
+ *
+ * This blocks while the fan is swept through its range several times, which
+ * can take several minutes with the default settling time. The fan is left
+ * stopped under manual control with the profile's settings applied.
+ *
+ *  - Each PWM clock candidate is swept coarsely and the one that gives the
+ *    most distinct speeds over the widest range is kept
+ *  - The transfer curve is measured at fan settings 0, 8, 16 ... 63
+ *  - The lowest setting that keeps the fan turning, and the lowest that starts
+ *    it from a stop with spin-up bypassed, are found
+ *  - Each spin-up time is tried at full drive, and the shortest after which
+ *    the fan keeps turning at its minimum setting is kept
+ *
+ * @param profile The profile to fill
+ * @param settle_ms How long to let the fan settle after each change before
+ * measuring it
+ * @return true: success false: failure, or no fan movement was detected
+ */
+bool Adafruit_EMC2101_FanCharacterizer::run(emc2101_fan_profile_t *profile,
+                                            uint16_t settle_ms) {
+  if (!profile || !_emc2101) {
+    return false;
+  }
+  memset(profile, 0, sizeof(*profile));
+  _period_ms = emc2101_rate_period_ms(_emc2101->getDataRate());
+
+  if (!_emc2101->LUTEnabled(false) || !_emc2101->configFanSpinup(false)) {
+    return false;
+  }
+
+  // pick the PWM clock giving the most distinct speeds over the widest range
+  uint8_t best = 0;
+  uint8_t best_steps = 0;
+  uint16_t best_range = 0;
+  for (uint8_t c = 0;
+       c < sizeof(_pwm_candidates) / sizeof(_pwm_candidates[0]); c++) {
+    if (!_applyPWM(&_pwm_candidates[c])) {
+      return false;
+    }
+    uint8_t steps = 0;
+    uint16_t low = 0, last = 0;
+    for (uint8_t duty = 15; duty <= MAX_LUT_SPEED; duty += 16) {
+      uint16_t rpm = _measureRPM(duty, settle_ms);
+      if (rpm == 0) {
+        continue;
+      }
+      if (low == 0) {
+        low = rpm;
+      }
+      // count steps that raise the speed by more than ~3%
+      if (rpm > last + (last >> 5)) {
+        steps++;
+        last = rpm;
+      }
+    }
+    uint16_t range = (last > low) ? last - low : 0;
+    if ((steps > best_steps) ||
+        ((steps == best_steps) && (range > best_range))) {
+      best = c;
+      best_steps = steps;
+      best_range = range;
+    }
+  }
+  if (best_steps == 0) {
+    _stop(0);
+    return false; // the fan never turned
+  }
+  if (!_applyPWM(&_pwm_candidates[best])) {
+    return false;
+  }
+  profile->pwm_freq = _pwm_candidates[best].pwm_freq;
+  profile->pwm_div = _pwm_candidates[best].pwm_div;
+  profile->flags = _pwm_candidates[best].flags;
+
+  // transfer curve, from the top down so the fan is already turning
+  for (int8_t i = EMC2101_PROFILE_POINTS - 1; i >= 0; i--) {
+    uint8_t duty = min(i * 8, MAX_LUT_SPEED);
+    profile->rpm[i] = _measureRPM(duty, settle_ms);
+  }
+
+  // lowest setting that keeps a turning fan going
+  uint8_t duty = MAX_LUT_SPEED;
+  uint16_t rpm = _measureRPM(duty, settle_ms);
+  while (duty > 1) {
+    uint16_t lower = _measureRPM(duty - 1, settle_ms);
+    if (lower == 0) {
+      break;
+    }
+    duty--;
+    rpm = lower;
+  }
+  profile->min_duty_raw = duty;
+  profile->min_rpm = (rpm >> 1) + (rpm >> 2); // 3/4 of the slowest speed
+
+  // lowest setting that starts a stopped fan without spin-up help
+  if (!_emc2101->configFanSpinup(0, 0)) {
+    return false;
+  }
+  profile->start_duty_raw = MAX_LUT_SPEED;
+  for (duty = profile->min_duty_raw; duty < MAX_LUT_SPEED; duty++) {
+    if (!_stop(settle_ms)) {
+      return false;
+    }
+    if (_timeToStart(duty, 0, settle_ms) != 0) {
+      profile->start_duty_raw = duty;
+      break;
+    }
+  }
+
+  // shortest full-drive spin-up that starts the fan at its minimum setting
+  if (!_emc2101->setFanMinRPM(profile->min_rpm)) {
+    return false;
+  }
+  profile->spinup_drive = 3;
+  profile->spinup_time = 7;
+  for (uint8_t time = 1; time <= 7; time++) {
+    if (!_emc2101->configFanSpinup(3, time) || !_stop(settle_ms)) {
+      return false;
+    }
+    uint16_t start_ms =
+        _timeToStart(profile->min_duty_raw, 25 << time, settle_ms);
+    if (start_ms != 0) {
+      profile->spinup_time = time;
+      profile->spinup_ms = start_ms;
+      break;
+    }
+  }
+
+  if (!_emc2101->configFanSpinup(profile->spinup_drive,
+                                 profile->spinup_time)) {
+    return false;
+  }
+  return _stop(0);
+}
+
+/**
+ * @brief Apply a PWM clock candidate
+ *
+ * @param candidate The settings to apply
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_FanCharacterizer::_applyPWM(
+    const pwm_candidate_t *candidate) {
+  return _emc2101->setPWMFrequency(candidate->pwm_freq) &&
+         _emc2101->setPWMDivisor(candidate->pwm_div) &&
+         _emc2101->configPWMClock(candidate->flags & EMC2101_PROFILE_CLKSEL,
+                                  candidate->flags & EMC2101_PROFILE_CLKOVR);
+}
+
+/**
+ * @brief Set the fan, wait for it to settle and measure its speed
+ *
+ * @param duty_raw The fan setting to measure
+ * @param settle_ms How long to wait before measuring
+ * @return uint16_t The average speed in RPM, 0 if stopped
+ */
+uint16_t Adafruit_EMC2101_FanCharacterizer::_measureRPM(uint8_t duty_raw,
+                                                       uint16_t settle_ms) {
+  if (!_emc2101->setDutyCycleRaw(duty_raw)) {
+    return 0;
+  }
+  delay(settle_ms);
+  return _sampleRPM();
+}
+
+/**
+ * @brief Average several tach readings, one per conversion period
+ *
+ * @return uint16_t The average speed in RPM, 0 if any reading was stopped
+ */
+uint16_t Adafruit_EMC2101_FanCharacterizer::_sampleRPM(void) {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < SAMPLES_PER_READING; i++) {
+    uint16_t rpm = _emc2101->getFanRPM();
+    if (rpm == 0) {
+      return 0;
+    }
+    total += rpm;
+    delay(_period_ms);
+  }
+  return total / SAMPLES_PER_READING;
+}
+
+/**
+ * @brief Stop the fan and wait for it to spin down
+ *
+ * @param settle_ms How long to wait
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_FanCharacterizer::_stop(uint16_t settle_ms) {
+  if (!_emc2101->setDutyCycleRaw(0)) {
+    return false;
+  }
+  delay(settle_ms);
+  return true;
+}
+
+/**
+ * @brief Start a stopped fan and time how long it takes to be detected
+ * turning. The chip's spin-up drive turns the fan on its own, so the fan only
+ * counts as started if it is still turning at `duty_raw` once the spin-up has
+ * ended and the fan has had time to settle
+ *
+ * @param duty_raw The fan setting to start with
+ * @param spinup_ms How long the configured spin-up drive lasts, 0 if bypassed
+ * @param timeout_ms How long to wait for the fan to start, and then to settle
+ * after the spin-up
+ * @return uint16_t The time in milliseconds, 0 if the fan didn't start
+ */
+uint16_t Adafruit_EMC2101_FanCharacterizer::_timeToStart(uint8_t duty_raw,
+                                                        uint16_t spinup_ms,
+                                                        uint16_t timeout_ms) {
+  uint32_t start = millis();
+  if (!_emc2101->setDutyCycleRaw(duty_raw)) {
+    return 0;
+  }
+  uint32_t elapsed = 0;
+  bool turning = false;
+  while (!turning && (elapsed < timeout_ms)) {
+    delay(_period_ms);
+    elapsed = millis() - start;
+    turning = (_emc2101->getFanRPM() != 0);
+  }
+  if (!turning) {
+    return 0;
+  }
+
+  uint32_t spinup_left = (elapsed < spinup_ms) ? spinup_ms - elapsed : 0;
+  delay(spinup_left + timeout_ms);
+  if (_sampleRPM() == 0) {
+    return 0; // only the spin-up drive was turning it
+  }
+  return (elapsed == 0) ? 1 : elapsed;
+}
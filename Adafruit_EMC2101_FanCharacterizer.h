@@ -0,0 +1,53 @@
+/*!
+ *  @file Adafruit_EMC2101_FanCharacterizer.h
+ *
+ * 	Measures how a fan attached to an EMC2101 responds to the fan setting, and
+ *chooses PWM and spin-up settings for it
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_EMC2101_FANCHARACTERIZER_H
+#define _ADAFRUIT_EMC2101_FANCHARACTERIZER_H
+
+#include "Adafruit_EMC2101.h"
+
+/*!
+ *    @brief  Class that sweeps an EMC2101's fan setting to build an
+ *            `emc2101_fan_profile_t` for the attached fan
+ */
+class Adafruit_EMC2101_FanCharacterizer {
+public:
+  Adafruit_EMC2101_FanCharacterizer(Adafruit_EMC2101 *emc2101);
+
+  bool run(emc2101_fan_profile_t *profile, uint16_t settle_ms = 3000);
+
+private:
+  /**
+   * @brief A PWM clock setting to try
+   */
+  typedef struct {
+    uint8_t pwm_freq; ///< `setPWMFrequency` setting
+    uint8_t pwm_div;  ///< `setPWMDivisor` setting
+    uint8_t flags;    ///< `EMC2101_PROFILE_CLKSEL`/`EMC2101_PROFILE_CLKOVR`
+  } pwm_candidate_t;
+
+  static const pwm_candidate_t _pwm_candidates[];
+
+  bool _applyPWM(const pwm_candidate_t *candidate);
+  uint16_t _measureRPM(uint8_t duty_raw, uint16_t settle_ms);
+  uint16_t _sampleRPM(void);
+  bool _stop(uint16_t settle_ms);
+  uint16_t _timeToStart(uint8_t duty_raw, uint16_t spinup_ms,
+                        uint16_t timeout_ms);
+
+  Adafruit_EMC2101 *_emc2101; ///< The fan controller being measured
+  uint16_t _period_ms = 0;    ///< Conversion period at the current data rate
+};
+
+#endif
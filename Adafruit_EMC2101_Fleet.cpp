@@ -0,0 +1,334 @@
+/*!
+ *  @file Adafruit_EMC2101_Fleet.cpp
+ *
+ * 	Manager for many EMC2101 fan controllers spread across I2C buses and
+ * TCA9548-style I2C multiplexers
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_Fleet.h"
+
+#if !defined(EMC2101_LINUX_HOST)
+
+/**
+ * @brief Construct a new, empty Adafruit_EMC2101_Fleet
+ *
+ */
+Adafruit_EMC2101_Fleet::Adafruit_EMC2101_Fleet(void) {}
+
+/**
+ * @brief Add a device and the route used to reach it. Devices are kept sorted
+ * by bus, multiplexer and channel so that reads of devices sharing a channel
+ * are grouped together.
+ *
+ * @param device The device driver. `begin()` on the fleet will begin it
+ * @param wire The bus the device, or the multiplexer it is behind, is on
+ * @param mux_addr The I2C address of the multiplexer, or `EMC2101_NO_MUX` if
+ * the device is connected directly to `wire`
+ * @param mux_channel The multiplexer channel the device is on, 0-7
+ * @return int8_t The index of the new device, or -1 if there is no room or
+ * the route is invalid
+ */
+int8_t Adafruit_EMC2101_Fleet::addDevice(Adafruit_EMC2101 *device,
+                                         TwoWire *wire, uint8_t mux_addr,
+                                         uint8_t mux_channel) {
+  if (!device || !wire || (_device_count >= EMC2101_FLEET_MAX_DEVICES) ||
+      (mux_channel > 7)) {
+    return -1;
+  }
+
+  uint8_t mux = EMC2101_NO_MUX;
+  if (mux_addr != EMC2101_NO_MUX) {
+    for (uint8_t i = 0; i < _mux_count; i++) {
+      if ((_muxes[i].wire == wire) && (_muxes[i].addr == mux_addr)) {
+        mux = i;
+      }
+    }
+    if (mux == EMC2101_NO_MUX) {
+      if (_mux_count >= EMC2101_FLEET_MAX_MUXES) {
+        return -1;
+      }
+      mux = _mux_count++;
+      _muxes[mux].wire = wire;
+      _muxes[mux].addr = mux_addr;
+      _muxes[mux].channels = EMC2101_MUX_UNKNOWN;
+    }
+  }
+
+  uint8_t index = _device_count++;
+  device->setBusLock(_lock_fn, _unlock_fn, _lock_context);
+  _routes[index].device = device;
+  _routes[index].wire = wire;
+  _routes[index].mux = mux;
+  _routes[index].channel = mux_channel;
+
+  // insert into the schedule after every device with a lower or equal route
+  uint8_t pos = index;
+  while ((pos > 0) && _routeBefore(index, _order[pos - 1])) {
+    _order[pos] = _order[pos - 1];
+    pos--;
+  }
+  _order[pos] = index;
+
+  return index;
+}
+
+/**
+ * @brief Begin every device in the fleet, selecting each route in turn
+ *
+ * @return true: every device was found and initialized false: at least one
+ * device failed. The others are still initialized
+ */
+bool Adafruit_EMC2101_Fleet::begin(void) {
+  bool success = true;
+  resetRoutes();
+  for (uint8_t i = 0; i < _device_count; i++) {
+    uint8_t index = _order[i];
+    BusGuard guard(this);
+    if (!select(index) ||
+        !_routes[index].device->begin(EMC2101_I2CADDR_DEFAULT,
+                                      _routes[index].wire)) {
+      success = false;
+    }
+  }
+  return success;
+}
+
+/**
+ * @brief Set the lock held while a route is selected and its device is used,
+ * so another task can't switch a multiplexer in between. The lock is also
+ * passed to `setBusLock` of every device in the fleet, so it must be
+ * recursive, and it covers all of the fleet's buses.
+ *
+ * `begin` and `readAll` take the lock themselves. Code that calls `select`
+ * and then uses a `device` must hold it across both, by taking the same mutex
+ * around them.
+ *
+ * @param lock Function that takes the lock, or NULL for no locking
+ * @param unlock Function that releases the lock
+ * @param context Passed to `lock` and `unlock`, usually the mutex
+ */
+void Adafruit_EMC2101_Fleet::setBusLock(emc2101_lock_fn_t lock,
+                                        emc2101_lock_fn_t unlock,
+                                        void *context) {
+  _lock_fn = unlock ? lock : NULL;
+  _unlock_fn = unlock;
+  _lock_context = context;
+  for (uint8_t i = 0; i < _device_count; i++) {
+    _routes[i].device->setBusLock(lock, unlock, context);
+  }
+}
+
+/**
+ * @brief Switch the multiplexers so that the given device can be reached.
+ * Multiplexers are only written when their channel needs to change, and any
+ * other multiplexer on the same bus is disabled so only one EMC2101 answers
+ * at its fixed address.
+ *
+ * With a lock set by `setBusLock`, hold it across this and the device
+ * transfers that follow
+ *
+ * @param index The device index returned by `addDevice`
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_Fleet::select(uint8_t index) {
+  BusGuard guard(this);
+  if (index >= _device_count) {
+    return false;
+  }
+  route_t *route = &_routes[index];
+
+  for (uint8_t i = 0; i < _mux_count; i++) {
+    if ((_muxes[i].wire != route->wire) || (i == route->mux)) {
+      continue;
+    }
+    if ((_muxes[i].channels != 0) && !_writeMux(i, 0)) {
+      return false;
+    }
+  }
+
+  if (route->mux == EMC2101_NO_MUX) {
+    return true;
+  }
+  uint8_t channels = 1 << route->channel;
+  if (_muxes[route->mux].channels == channels) {
+    return true;
+  }
+  return _writeMux(route->mux, channels);
+}
+
+/**
+ * @brief Forget the multiplexer states, so that the next `select` writes them.
+ * Use this after a bus reset or anything else that may have switched channels
+ *
+ */
+void Adafruit_EMC2101_Fleet::resetRoutes(void) {
+  for (uint8_t i = 0; i < _mux_count; i++) {
+    _muxes[i].channels = EMC2101_MUX_UNKNOWN;
+  }
+}
+
+/**
+ * @brief Read a snapshot from every device.
+ *
+ * Devices are read grouped by bus and multiplexer channel, so each channel is
+ * selected at most once per call. The device the read starts with rotates
+ * between calls so that no device is always read last.
+ *
+ * @param snapshots Array of `deviceCount()` snapshots, indexed by the device
+ * index returned by `addDevice`
+ * @param ok Optional array of `deviceCount()` flags, set to whether each
+ * device was read successfully
+ * @return uint8_t The number of devices read successfully
+ */
+uint8_t Adafruit_EMC2101_Fleet::readAll(emc2101_snapshot_t *snapshots,
+                                        bool *ok) {
+  if (!snapshots || (_device_count == 0)) {
+    return 0;
+  }
+
+  uint8_t read_count = 0;
+  uint8_t start = _next_start;
+  for (uint8_t i = 0; i < _device_count; i++) {
+    uint8_t index = _order[(start + i) % _device_count];
+    // another task mustn't switch channels between the select and the read
+    BusGuard guard(this);
+    bool success = select(index) &&
+                   _routes[index].device->readSnapshot(&snapshots[index]);
+    if (ok) {
+      ok[index] = success;
+    }
+    if (success) {
+      read_count++;
+    }
+  }
+
+  // start the next pass at the following channel group
+  uint8_t next = (start + 1) % _device_count;
+  while ((next != start) &&
+         _sameRoute(_order[next], _order[(next + _device_count - 1) %
+                                         _device_count])) {
+    next = (next + 1) % _device_count;
+  }
+  _next_start = next;
+
+  return read_count;
+}
+
+/**
+ * @brief Get the driver for a device in the fleet. Call `select` before
+ * using it directly, holding the `setBusLock` lock across both
+ *
+ * @param index The device index returned by `addDevice`
+ * @return Adafruit_EMC2101* The device, or NULL for an invalid index
+ */
+Adafruit_EMC2101 *Adafruit_EMC2101_Fleet::device(uint8_t index) {
+  if (index >= _device_count) {
+    return NULL;
+  }
+  return _routes[index].device;
+}
+
+/**
+ * @brief Get the number of devices in the fleet
+ *
+ * @return uint8_t The number of devices added with `addDevice`
+ */
+uint8_t Adafruit_EMC2101_Fleet::deviceCount(void) { return _device_count; }
+
+/**
+ * @brief Get the number of multiplexer writes made so far
+ *
+ * @return uint32_t The number of channel switches
+ */
+uint32_t Adafruit_EMC2101_Fleet::channelSwitchCount(void) { return _switches; }
+
+/**
+ * @brief Take the fleet's bus lock, if one is set
+ *
+ * @param fleet The fleet whose lock to take
+ */
+Adafruit_EMC2101_Fleet::BusGuard::BusGuard(Adafruit_EMC2101_Fleet *fleet) {
+  _fleet = fleet;
+  if (_fleet->_lock_fn) {
+    _fleet->_lock_fn(_fleet->_lock_context);
+  }
+}
+
+/**
+ * @brief Release the fleet's bus lock, if one is set
+ */
+Adafruit_EMC2101_Fleet::BusGuard::~BusGuard() {
+  if (_fleet->_lock_fn) {
+    _fleet->_unlock_fn(_fleet->_lock_context);
+  }
+}
+
+/**
+ * @brief Write a channel mask to a multiplexer
+ *
+ * @param mux The index of the multiplexer in `_muxes`
+ * @param channels The channel mask to enable
+ * @return true: success false: failure. The multiplexer state is unknown
+ * after a failure
+ */
+bool Adafruit_EMC2101_Fleet::_writeMux(uint8_t mux, uint8_t channels) {
+  TwoWire *wire = _muxes[mux].wire;
+  _switches++;
+  wire->beginTransmission(_muxes[mux].addr);
+  wire->write(channels);
+  if (wire->endTransmission() != 0) {
+    _muxes[mux].channels = EMC2101_MUX_UNKNOWN;
+    return false;
+  }
+  _muxes[mux].channels = channels;
+  return true;
+}
+
+/**
+ * @brief Compare the routes of two devices for scheduling. Routes are ordered
+ * by bus, in the order the buses were first added, then by multiplexer and
+ * channel, with devices connected directly to the bus last
+ *
+ * @param a The first device index
+ * @param b The second device index
+ * @return true: `a` should be read before `b`
+ */
+bool Adafruit_EMC2101_Fleet::_routeBefore(uint8_t a, uint8_t b) {
+  route_t *route_a = &_routes[a];
+  route_t *route_b = &_routes[b];
+  if (route_a->wire != route_b->wire) {
+    for (uint8_t i = 0; i < _device_count; i++) {
+      if (_routes[i].wire == route_a->wire) {
+        return true;
+      }
+      if (_routes[i].wire == route_b->wire) {
+        return false;
+      }
+    }
+  }
+  if (route_a->mux != route_b->mux) {
+    return route_a->mux < route_b->mux;
+  }
+  return route_a->channel < route_b->channel;
+}
+
+/**
+ * @brief Check if two devices are reached the same way
+ *
+ * @param a The first device index
+ * @param b The second device index
+ * @return true: same bus, multiplexer and channel false: different routes
+ */
+bool Adafruit_EMC2101_Fleet::_sameRoute(uint8_t a, uint8_t b) {
+  return (_routes[a].wire == _routes[b].wire) &&
+         (_routes[a].mux == _routes[b].mux) &&
+         (_routes[a].channel == _routes[b].channel);
+}
+
+#endif
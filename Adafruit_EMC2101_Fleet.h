@@ -0,0 +1,110 @@
+/*!
+ *  @file Adafruit_EMC2101_Fleet.h
+ *
+ * 	Manager for many EMC2101 fan controllers spread across I2C buses and
+ *TCA9548-style I2C multiplexers
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_EMC2101_FLEET_H
+#define _ADAFRUIT_EMC2101_FLEET_H
+
+#include "Adafruit_EMC2101.h"
+
+// The fleet routes through TwoWire multiplexers, so it is Arduino only
+#if !defined(EMC2101_LINUX_HOST)
+
+#ifndef EMC2101_FLEET_MAX_DEVICES
+#define EMC2101_FLEET_MAX_DEVICES 16 ///< Maximum devices in a fleet
+#endif
+#ifndef EMC2101_FLEET_MAX_MUXES
+#define EMC2101_FLEET_MAX_MUXES 8 ///< Maximum multiplexers in a fleet
+#endif
+
+#define EMC2101_NO_MUX 0xFF ///< Route for a device connected directly to a bus
+#define EMC2101_MUX_UNKNOWN                                                    \
+  0xFF ///< Channel mask for a multiplexer in an unknown state
+
+/*!
+ *    @brief  Class that owns the routes to a group of EMC2101s and schedules
+ *            reads across them so multiplexer channel switches are minimized
+ */
+class Adafruit_EMC2101_Fleet {
+public:
+  Adafruit_EMC2101_Fleet();
+
+  int8_t addDevice(Adafruit_EMC2101 *device, TwoWire *wire = &Wire,
+                   uint8_t mux_addr = EMC2101_NO_MUX, uint8_t mux_channel = 0);
+  bool begin(void);
+
+  void setBusLock(emc2101_lock_fn_t lock, emc2101_lock_fn_t unlock,
+                  void *context);
+
+  bool select(uint8_t index);
+  void resetRoutes(void);
+
+  uint8_t readAll(emc2101_snapshot_t *snapshots, bool *ok = NULL);
+
+  Adafruit_EMC2101 *device(uint8_t index);
+  uint8_t deviceCount(void);
+  uint32_t channelSwitchCount(void);
+
+private:
+  /*!
+   *    @brief  Holds the fleet's bus lock, if one is set, for as long as it
+   *            is in scope
+   */
+  class BusGuard {
+  public:
+    BusGuard(Adafruit_EMC2101_Fleet *fleet);
+    ~BusGuard();
+
+  private:
+    Adafruit_EMC2101_Fleet *_fleet; ///< The fleet whose lock is held
+  };
+
+  /**
+   * @brief How to reach a single device
+   */
+  typedef struct {
+    Adafruit_EMC2101 *device; ///< The device driver
+    TwoWire *wire;            ///< The bus the device or its mux is on
+    uint8_t mux;              ///< Index into `_muxes`, or EMC2101_NO_MUX
+    uint8_t channel;          ///< Multiplexer channel, 0-7
+  } route_t;
+
+  /**
+   * @brief A multiplexer and the channel mask last written to it
+   */
+  typedef struct {
+    TwoWire *wire;    ///< The bus the multiplexer is on
+    uint8_t addr;     ///< The multiplexer's I2C address
+    uint8_t channels; ///< Enabled channel mask, or EMC2101_MUX_UNKNOWN
+  } mux_t;
+
+  bool _writeMux(uint8_t mux, uint8_t channels);
+  bool _routeBefore(uint8_t a, uint8_t b);
+  bool _sameRoute(uint8_t a, uint8_t b);
+
+  route_t _routes[EMC2101_FLEET_MAX_DEVICES]; ///< Routes in order of addition
+  uint8_t _order[EMC2101_FLEET_MAX_DEVICES];  ///< Indices sorted by route
+  mux_t _muxes[EMC2101_FLEET_MAX_MUXES];      ///< Known multiplexers
+  uint8_t _device_count = 0;                  ///< Number of devices added
+  uint8_t _mux_count = 0;                     ///< Number of muxes seen
+  uint8_t _next_start = 0; ///< Position in `_order` to start the next read
+  uint32_t _switches = 0;  ///< Multiplexer writes performed
+
+  emc2101_lock_fn_t _lock_fn = NULL;   ///< Takes the bus lock
+  emc2101_lock_fn_t _unlock_fn = NULL; ///< Releases the bus lock
+  void *_lock_context = NULL;          ///< Passed to the lock functions
+};
+
+#endif
+
+#endif
@@ -0,0 +1,156 @@
+/*!
+ *  @file Adafruit_EMC2101_Instrumentation.cpp
+ *
+ * 	Optional per-method call counts, bus transfer counts and latency
+ * histograms for the EMC2101 driver
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101.h"
+
+#if EMC2101_INSTRUMENTATION
+
+static emc2101_method_stats_t *_methods = NULL; ///< Methods called so far
+static emc2101_method_stats_t *_current = NULL; ///< Innermost timed method
+
+/**
+ * @brief Start timing a call, adding the method to the dump list on its first
+ * call
+ *
+ * @param stats The method's counters
+ */
+Adafruit_EMC2101_ScopedTimer::Adafruit_EMC2101_ScopedTimer(
+    emc2101_method_stats_t *stats) {
+  if (!stats->listed) {
+    stats->listed = true;
+    stats->next = _methods;
+    _methods = stats;
+  }
+  _stats = stats;
+  _outer = _current;
+  _current = stats;
+  _start_us = micros();
+}
+
+/**
+ * @brief Finish timing a call and update the method's counters
+ */
+Adafruit_EMC2101_ScopedTimer::~Adafruit_EMC2101_ScopedTimer() {
+  uint32_t elapsed_us = micros() - _start_us;
+  _current = _outer;
+
+  _stats->calls++;
+  _stats->total_us += elapsed_us;
+  if (elapsed_us > _stats->max_us) {
+    _stats->max_us = elapsed_us;
+  }
+  uint8_t bucket = 0;
+  uint32_t bound = EMC2101_INSTR_BUCKET_MIN_US;
+  while ((bucket < EMC2101_INSTR_BUCKETS - 1) && (elapsed_us >= bound)) {
+    bucket++;
+    bound *= 2;
+  }
+  _stats->histogram[bucket]++;
+}
+
+/**
+ * @brief Count one register transfer against the innermost method being
+ * timed. Called by the driver for every attempt, including retries
+ *
+ * @param bytes The bytes on the bus, including address bytes
+ */
+void emc2101_instrumentation_transfer(uint8_t bytes) {
+  if (_current) {
+    _current->transfers++;
+    _current->bytes += bytes;
+  }
+}
+
+/**
+ * @brief Zero the counters of every method called so far
+ */
+void emc2101_instrumentation_reset(void) {
+  for (emc2101_method_stats_t *m = _methods; m; m = m->next) {
+    m->calls = 0;
+    m->transfers = 0;
+    m->bytes = 0;
+    m->total_us = 0;
+    m->max_us = 0;
+    memset(m->histogram, 0, sizeof(m->histogram));
+  }
+}
+
+/**
+ * @brief Write one line of the dump
+ *
+ * @param out Where to write
+ * @param line The text to write
+ */
+static void _emit(emc2101_dump_out_t *out, const char *line) {
+#if defined(EMC2101_LINUX_HOST)
+  fputs(line, out);
+#else
+  out->print(line);
+#endif
+}
+
+/**
+ * @brief Write the counters of every method called so far, as a table with
+ * one row per method or as a JSON array.
+ *
+ * Bucket `i` of the latency histogram counts calls shorter than
+ * `EMC2101_INSTR_BUCKET_MIN_US << i` microseconds, and the last bucket counts
+ * everything longer. Transfers are counted against the innermost
+ * instrumented method, while a method's time includes the methods it calls
+ *
+ * @param out Where to write, such as `&Serial`, or `stdout` on a Linux host
+ * @param json true for JSON, false for a table
+ */
+void emc2101_instrumentation_dump(emc2101_dump_out_t *out, bool json) {
+  char line[96];
+  if (json) {
+    _emit(out, "[");
+  } else {
+    snprintf(line, sizeof(line), "%-28s %7s %7s %8s %7s %7s  histogram\n",
+             "method", "calls", "xfers", "bytes", "avg_us", "max_us");
+    _emit(out, line);
+  }
+
+  for (emc2101_method_stats_t *m = _methods; m; m = m->next) {
+    unsigned long avg_us = m->calls ? m->total_us / m->calls : 0;
+    if (json) {
+      snprintf(line, sizeof(line),
+               "%s{\"method\":\"%s\",\"calls\":%lu,\"transfers\":%lu,"
+               "\"bytes\":%lu,",
+               (m == _methods) ? "" : ",", m->name, (unsigned long)m->calls,
+               (unsigned long)m->transfers, (unsigned long)m->bytes);
+      _emit(out, line);
+      snprintf(line, sizeof(line), "\"avg_us\":%lu,\"max_us\":%lu,\"hist\":[",
+               avg_us, (unsigned long)m->max_us);
+    } else {
+      snprintf(line, sizeof(line), "%-28s %7lu %7lu %8lu %7lu %7lu ", m->name,
+               (unsigned long)m->calls, (unsigned long)m->transfers,
+               (unsigned long)m->bytes, avg_us, (unsigned long)m->max_us);
+    }
+    _emit(out, line);
+
+    for (uint8_t i = 0; i < EMC2101_INSTR_BUCKETS; i++) {
+      snprintf(line, sizeof(line), "%s%lu",
+               (i == 0) ? (json ? "" : " ") : (json ? "," : "/"),
+               (unsigned long)m->histogram[i]);
+      _emit(out, line);
+    }
+    _emit(out, json ? "]}" : "\n");
+  }
+
+  if (json) {
+    _emit(out, "]\n");
+  }
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*!
+ *  @file Adafruit_EMC2101_Instrumentation.h
+ *
+ * 	Optional per-method call counts, bus transfer counts and latency
+ *histograms for the EMC2101 driver. Everything here compiles to nothing
+ *unless EMC2101_INSTRUMENTATION is defined to 1
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_EMC2101_INSTRUMENTATION_H
+#define _ADAFRUIT_EMC2101_INSTRUMENTATION_H
+
+#if defined(EMC2101_LINUX_HOST)
+#include <stdint.h>
+#include <stdio.h>
+#else
+#include "Arduino.h"
+#endif
+
+#ifndef EMC2101_INSTRUMENTATION
+#define EMC2101_INSTRUMENTATION 0 ///< Set to 1 with a build flag to enable
+#endif
+
+#if EMC2101_INSTRUMENTATION
+
+#define EMC2101_INSTR_BUCKETS 8 ///< Number of latency histogram buckets
+#define EMC2101_INSTR_BUCKET_MIN_US                                            \
+  64 ///< Upper bound of the first bucket. Each bucket after it doubles
+
+#if defined(EMC2101_LINUX_HOST)
+typedef FILE emc2101_dump_out_t; ///< Where `emc2101_instrumentation_dump`
+                                 ///< writes on a Linux host
+#else
+typedef Print emc2101_dump_out_t; ///< Where `emc2101_instrumentation_dump`
+                                  ///< writes on Arduino
+#endif
+
+/**
+ * @brief Counters for one instrumented method, shared by all driver instances
+ */
+typedef struct emc2101_method_stats {
+  const char *name;                  ///< The method's name
+  struct emc2101_method_stats *next; ///< Next method in the dump list
+  bool listed;                       ///< Already in the dump list
+  uint32_t calls;                    ///< Number of calls
+  uint32_t transfers;                ///< Register transfers, with retries
+  uint32_t bytes;                    ///< Bytes on the bus, with addresses
+  uint32_t total_us;                 ///< Time spent in the method
+  uint32_t max_us;                   ///< Longest single call
+  uint32_t histogram[EMC2101_INSTR_BUCKETS]; ///< Calls by latency bucket
+} emc2101_method_stats_t;
+
+/*!
+ *    @brief  Times one call of an instrumented method and makes it the method
+ *            that bus transfers are counted against until it returns
+ */
+class Adafruit_EMC2101_ScopedTimer {
+public:
+  Adafruit_EMC2101_ScopedTimer(emc2101_method_stats_t *stats);
+  ~Adafruit_EMC2101_ScopedTimer();
+
+private:
+  emc2101_method_stats_t *_stats; ///< The method being timed
+  emc2101_method_stats_t *_outer; ///< The method that called it, if any
+  uint32_t _start_us;             ///< When the call started
+};
+
+void emc2101_instrumentation_transfer(uint8_t bytes);
+void emc2101_instrumentation_reset(void);
+void emc2101_instrumentation_dump(emc2101_dump_out_t *out, bool json = false);
+
+#define EMC2101_INSTRUMENT(method_name)                                        \
+  static emc2101_method_stats_t _emc2101_stats = {                             \
+      method_name, NULL, false, 0, 0, 0, 0, 0, {0}};                           \
+  Adafruit_EMC2101_ScopedTimer _emc2101_timer(                                 \
+      &_emc2101_stats) ///< Count and time the enclosing method
+#define EMC2101_INSTRUMENT_TRANSFER(bytes)                                     \
+  emc2101_instrumentation_transfer(                                            \
+      bytes) ///< Count a transfer against the innermost instrumented method
+
+#else
+
+#define EMC2101_INSTRUMENT(method_name)    ///< Disabled, compiles to nothing
+#define EMC2101_INSTRUMENT_TRANSFER(bytes) ///< Disabled, compiles to nothing
+
+#endif
+
+#endif
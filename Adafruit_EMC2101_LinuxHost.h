@@ -0,0 +1,158 @@
+/*!
+ *  @file Adafruit_EMC2101_LinuxHost.h
+ *
+ * 	The few Arduino core functions the EMC2101 driver uses, for building it
+ *natively on Linux without Arduino
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_EMC2101_LINUXHOST_H
+#define _ADAFRUIT_EMC2101_LINUXHOST_H
+
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @brief The clock behind `millis`, `micros` and the delays. Host tests can
+ * switch it to simulated time, which only moves when something waits, so runs
+ * against the simulated EMC2101 in extras/simulator are fast and repeatable
+ */
+typedef struct {
+  bool simulated;  ///< Use `now_us` instead of the system clock
+  uint64_t now_us; ///< The simulated time in microseconds
+} emc2101_host_clock_t;
+
+/**
+ * @brief Get the clock used by the timing functions
+ *
+ * @code
+ * emc2101_host_clock()->simulated = true; // time stands still until a delay
+ * @endcode
+ *
+ * @return emc2101_host_clock_t* The clock, shared by the whole program
+ */
+inline emc2101_host_clock_t *emc2101_host_clock(void) {
+  static emc2101_host_clock_t clock = {false, 0};
+  return &clock;
+}
+
+/**
+ * @brief Get the time since an arbitrary fixed point, like Arduino's
+ * `micros()`
+ *
+ * @return uint32_t The time in microseconds, wrapping
+ */
+inline uint32_t micros(void) {
+  if (emc2101_host_clock()->simulated) {
+    return emc2101_host_clock()->now_us;
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Get the time since an arbitrary fixed point, like Arduino's
+ * `millis()`
+ *
+ * @return uint32_t The time in milliseconds, wrapping
+ */
+inline uint32_t millis(void) {
+  if (emc2101_host_clock()->simulated) {
+    return emc2101_host_clock()->now_us / 1000;
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Sleep for a number of microseconds
+ *
+ * @param us The time to sleep
+ */
+inline void delayMicroseconds(uint32_t us) {
+  if (emc2101_host_clock()->simulated) {
+    emc2101_host_clock()->now_us += us;
+    return;
+  }
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+/**
+ * @brief Sleep for a number of milliseconds
+ *
+ * @param ms The time to sleep
+ */
+inline void delay(uint32_t ms) {
+  if (emc2101_host_clock()->simulated) {
+    emc2101_host_clock()->now_us += (uint64_t)ms * 1000;
+    return;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+/**
+ * @brief The smaller of two values, like Arduino's `min` but without a macro
+ * that would break `std::min`
+ *
+ * @param a The first value
+ * @param b The second value
+ * @return The smaller value
+ */
+template <class T, class U>
+inline typename std::common_type<T, U>::type min(T a, U b) {
+  return (a < b) ? a : b;
+}
+
+/**
+ * @brief The larger of two values, like Arduino's `max`
+ *
+ * @param a The first value
+ * @param b The second value
+ * @return The larger value
+ */
+template <class T, class U>
+inline typename std::common_type<T, U>::type max(T a, U b) {
+  return (a > b) ? a : b;
+}
+
+/**
+ * @brief Limit a value to a range, like Arduino's `constrain`
+ *
+ * @param amt The value
+ * @param low The lowest allowed value
+ * @param high The highest allowed value
+ * @return The limited value
+ */
+template <class T, class L, class H>
+inline T constrain(T amt, L low, H high) {
+  return (amt < low) ? low : ((amt > high) ? high : amt);
+}
+
+/**
+ * @brief Re-map a number from one range to another, like Arduino's `map`
+ *
+ * @param x The value to map
+ * @param in_min The lower bound of the value's range
+ * @param in_max The upper bound of the value's range
+ * @param out_min The lower bound of the target range
+ * @param out_max The upper bound of the target range
+ * @return long The mapped value
+ */
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+#endif
@@ -0,0 +1,249 @@
+/*!
+ *  @file Adafruit_EMC2101_RPMController.cpp
+ *
+ * 	Closed loop fan speed controller for the EMC2101, driving the fan setting
+ * from tachometer feedback
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_RPMController.h"
+
+/**
+ * @brief Construct a new Adafruit_EMC2101_RPMController
+ *
+ * @param emc2101 The fan controller to drive. It must already be started
+ * with `begin()`
+ */
+Adafruit_EMC2101_RPMController::Adafruit_EMC2101_RPMController(
+    Adafruit_EMC2101 *emc2101) {
+  _emc2101 = emc2101;
+}
+
+/**
+ * @brief Prepare the controller and take the fan setting over from the LUT.
+ *
+ * The control period is the chip's conversion period from `setDataRate`, since
+ * the tach reading can't change faster than that. The minimum RPM from
+ * `setFanMinRPM` is used as the lowest non-zero target. Call `begin` again
+ * after changing either of them. The fan speed is read so the first tick
+ * measures its change from now, not from an earlier run.
+ *
+ * @param spinup_ms How long the spin-up drive configured with
+ * `configFanSpinup` lasts, in milliseconds. The integral term is frozen for
+ * this long after starting the fan from a stop, so the controller doesn't
+ * wind up while the chip is driving the fan on its own
+ * @return true: success false: failure, including a data rate that couldn't
+ * be read
+ */
+bool Adafruit_EMC2101_RPMController::begin(uint16_t spinup_ms) {
+  if (!_emc2101) {
+    return false;
+  }
+  _period_ms = emc2101_rate_period_ms(_emc2101->getDataRate());
+  if (_period_ms == 0) {
+    return false; // every call to `update` would run a tick
+  }
+  _min_rpm = _emc2101->getFanMinRPM();
+  _spinup_ms = spinup_ms;
+  _duty = _emc2101->getDutyCycleRaw();
+  _integral = (int32_t)_duty << EMC2101_PID_SHIFT; // bumpless start
+  // start the derivative from the current speed, not the last run's
+  uint16_t tach;
+  if (!_emc2101->getFanTachRaw(&tach)) {
+    return false;
+  }
+  _last_rpm = emc2101_tach_to_rpm(tach);
+  _spinning_up = false;
+  _ticks = 0;
+  _faults = 0;
+  _next_tick_ms = 0;
+  return _emc2101->LUTEnabled(false);
+}
+
+/**
+ * @brief Set the speed to hold. Non-zero targets below the fan's minimum RPM
+ * are raised to it
+ *
+ * @param target_rpm The target speed in RPM, or 0 to stop the fan
+ */
+void Adafruit_EMC2101_RPMController::setTarget(uint16_t target_rpm) {
+  if ((target_rpm != 0) && (target_rpm < _min_rpm)) {
+    target_rpm = _min_rpm;
+  }
+  _target_rpm = target_rpm;
+}
+
+/**
+ * @brief Get the speed being held
+ *
+ * @return uint16_t The target speed in RPM
+ */
+uint16_t Adafruit_EMC2101_RPMController::getTarget(void) { return _target_rpm; }
+
+/**
+ * @brief Set the controller gains. Each gain is a fixed point value with
+ * `EMC2101_PID_SHIFT` fractional bits, in raw duty cycle steps (1/63 of full
+ * speed) per RPM of error. For example a `kp` of 41 adds one duty cycle step
+ * for every 100 RPM below the target
+ *
+ * @param kp The proportional gain
+ * @param ki The integral gain, applied once per tick
+ * @param kd The derivative gain, applied to the change in measured RPM per tick
+ */
+void Adafruit_EMC2101_RPMController::setTunings(int16_t kp, int16_t ki,
+                                                int16_t kd) {
+  _kp = kp;
+  _ki = ki;
+  _kd = kd;
+}
+
+/**
+ * @brief Limit how much the fan setting may change on each tick
+ *
+ * @param max_step The largest change in raw duty cycle steps, 1 to
+ * `MAX_LUT_SPEED`
+ */
+void Adafruit_EMC2101_RPMController::setSlewLimit(uint8_t max_step) {
+  _max_step = constrain(max_step, 1, MAX_LUT_SPEED);
+}
+
+/**
+ * @brief Set the fan setting to use when the tach can't be read. The
+ * controller holds this setting until a reading succeeds again, then
+ * continues from it without a bump
+ *
+ * @param safe_duty The raw duty cycle, 0 to `MAX_LUT_SPEED`. Defaults to full
+ * speed
+ */
+void Adafruit_EMC2101_RPMController::setSafeDutyCycleRaw(uint8_t safe_duty) {
+  _safe_duty = min(safe_duty, (uint8_t)MAX_LUT_SPEED);
+}
+
+/**
+ * @brief Run the controller if a tick is due. Ticks are scheduled at fixed
+ * intervals of the conversion period, so calling this more often than that
+ * costs no bus traffic. Each tick reads the tach count (two register reads)
+ * and writes the fan setting at most once, only if it changed.
+ *
+ * If the tach read fails the fan is set to the `setSafeDutyCycleRaw` setting
+ * instead of acting on the bad reading. The driver's `lastError` is left for
+ * the application to check and clear
+ *
+ * @param now_ms The current time, usually from `millis()`
+ * @return true: a tick ran false: no tick was due yet
+ */
+bool Adafruit_EMC2101_RPMController::update(uint32_t now_ms) {
+  if ((_ticks > 0) && ((int32_t)(now_ms - _next_tick_ms) < 0)) {
+    return false;
+  }
+  // stay on the fixed schedule unless we've fallen more than a tick behind
+  _next_tick_ms += _period_ms;
+  if ((_ticks == 0) || ((int32_t)(now_ms - _next_tick_ms) >= 0)) {
+    _next_tick_ms = now_ms + _period_ms;
+  }
+  _ticks++;
+
+  uint16_t tach;
+  if (!_emc2101->getFanTachRaw(&tach)) {
+    _faults++;
+    _integral = (int32_t)_safe_duty << EMC2101_PID_SHIFT;
+    if (_emc2101->setDutyCycleRaw(_safe_duty)) {
+      _duty = _safe_duty;
+    }
+    return true;
+  }
+
+  uint16_t rpm = emc2101_tach_to_rpm(tach);
+  int32_t error = (int32_t)_target_rpm - rpm;
+  int32_t d_rpm = (int32_t)rpm - _last_rpm;
+  _last_rpm = rpm;
+
+  int32_t output;
+  if (_target_rpm == 0) {
+    _integral = 0;
+    _spinning_up = false;
+    output = 0;
+  } else {
+    if (_duty == 0) {
+      // the chip applies its spin-up drive when starting from a stop
+      _spinning_up = true;
+      _spinup_end_ms = now_ms + _spinup_ms;
+    }
+    if (_spinning_up && ((int32_t)(now_ms - _spinup_end_ms) >= 0)) {
+      _spinning_up = false;
+    }
+
+    // each term is clamped far beyond full speed, so their sum can't overflow
+    const int32_t max_term = (int32_t)1 << 28;
+    const int32_t max_output = (int32_t)MAX_LUT_SPEED << EMC2101_PID_SHIFT;
+    int32_t p_term = constrain((int32_t)_kp * error, -max_term, max_term);
+    // derivative on measurement
+    int32_t d_term = constrain(-(int32_t)_kd * d_rpm, -max_term, max_term);
+    int32_t new_integral = _integral;
+    if (!_spinning_up) {
+      new_integral += constrain((int32_t)_ki * error, -max_term, max_term);
+    }
+
+    output = p_term + new_integral + d_term;
+    // anti-windup: only integrate while the output isn't saturated in the
+    // direction the integral is pushing, and keep the integral in range
+    if (!(((output > max_output) && (new_integral > _integral)) ||
+          ((output < 0) && (new_integral < _integral)))) {
+      _integral = constrain(new_integral, 0, max_output);
+    }
+    output = p_term + _integral + d_term;
+    output = constrain(output, 0, max_output);
+    output = (output + (1 << (EMC2101_PID_SHIFT - 1))) >> EMC2101_PID_SHIFT;
+    if (output == 0) {
+      output = 1; // a non-zero target never stops the fan
+    }
+  }
+
+  if (output > _duty + _max_step) {
+    output = _duty + _max_step;
+  } else if (output < _duty - _max_step) {
+    output = _duty - _max_step;
+  }
+  if (_target_rpm == 0) {
+    output = 0; // stopping isn't slew limited
+  }
+
+  if (_emc2101->setDutyCycleRaw(output)) {
+    _duty = output;
+  }
+  return true;
+}
+
+/**
+ * @brief Get the speed measured on the last tick
+ *
+ * @return uint16_t The fan speed in RPM
+ */
+uint16_t Adafruit_EMC2101_RPMController::lastRPM(void) { return _last_rpm; }
+
+/**
+ * @brief Get the fan setting written on the last tick
+ *
+ * @return uint8_t The raw duty cycle, 0 to `MAX_LUT_SPEED`
+ */
+uint8_t Adafruit_EMC2101_RPMController::lastDutyCycleRaw(void) { return _duty; }
+
+/**
+ * @brief Get the number of control ticks run since `begin`
+ *
+ * @return uint32_t The tick count
+ */
+uint32_t Adafruit_EMC2101_RPMController::tickCount(void) { return _ticks; }
+
+/**
+ * @brief Get the number of ticks where the tach could not be read and the
+ * safe fan setting was used
+ *
+ * @return uint32_t The fault count
+ */
+uint32_t Adafruit_EMC2101_RPMController::faultCount(void) { return _faults; }
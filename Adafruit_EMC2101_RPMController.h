@@ -0,0 +1,68 @@
+/*!
+ *  @file Adafruit_EMC2101_RPMController.h
+ *
+ * 	Closed loop fan speed controller for the EMC2101, driving the fan setting
+ *from tachometer feedback
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_EMC2101_RPMCONTROLLER_H
+#define _ADAFRUIT_EMC2101_RPMCONTROLLER_H
+
+#include "Adafruit_EMC2101.h"
+
+#define EMC2101_PID_SHIFT 12 ///< Fractional bits of the controller gains
+
+/*!
+ *    @brief  Integer PID controller that holds a fan at a target RPM by
+ *            adjusting the EMC2101 fan setting once per conversion period
+ */
+class Adafruit_EMC2101_RPMController {
+public:
+  Adafruit_EMC2101_RPMController(Adafruit_EMC2101 *emc2101);
+
+  bool begin(uint16_t spinup_ms = 0);
+
+  void setTarget(uint16_t target_rpm);
+  uint16_t getTarget(void);
+
+  void setTunings(int16_t kp, int16_t ki, int16_t kd);
+  void setSlewLimit(uint8_t max_step);
+  void setSafeDutyCycleRaw(uint8_t safe_duty);
+
+  bool update(uint32_t now_ms);
+
+  uint16_t lastRPM(void);
+  uint8_t lastDutyCycleRaw(void);
+  uint32_t tickCount(void);
+  uint32_t faultCount(void);
+
+private:
+  Adafruit_EMC2101 *_emc2101; ///< The fan controller being driven
+
+  uint16_t _period_ms = 0;  ///< Time between control ticks
+  uint16_t _spinup_ms = 0;  ///< Time the chip's spin-up drive lasts
+  uint16_t _min_rpm = 0;    ///< Lowest speed the fan is specified for
+  uint16_t _target_rpm = 0; ///< The speed to hold
+  int16_t _kp = 0;          ///< Proportional gain, Q12 duty LSBs per RPM
+  int16_t _ki = 0;          ///< Integral gain, Q12 duty LSBs per RPM tick
+  int16_t _kd = 0;          ///< Derivative gain, Q12 duty LSBs per RPM/tick
+  uint8_t _max_step = MAX_LUT_SPEED;  ///< Largest duty change per tick
+  int32_t _integral = 0;              ///< Integral term, Q12 duty LSBs
+  uint16_t _last_rpm = 0;             ///< Speed measured on the last tick
+  uint8_t _duty = 0;                  ///< Fan setting written on the last tick
+  uint32_t _next_tick_ms = 0;         ///< When the next tick is due
+  uint32_t _spinup_end_ms = 0;        ///< Integration is held until this time
+  bool _spinning_up = false;          ///< The fan was started from a stop
+  uint32_t _ticks = 0;                ///< Number of control ticks run
+  uint8_t _safe_duty = MAX_LUT_SPEED; ///< Fan setting used when reads fail
+  uint32_t _faults = 0; ///< Ticks where the tach could not be read
+};
+
+#endif
@@ -0,0 +1,246 @@
+/*!
+ *  @file Adafruit_EMC2101_Telemetry.h
+ *
+ * 	Fixed size, allocation free history of timestamped EMC2101 readings
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_EMC2101_TELEMETRY_H
+#define _ADAFRUIT_EMC2101_TELEMETRY_H
+
+#include "Adafruit_EMC2101.h"
+
+/**
+ * @brief A single timestamped reading stored in the history
+ */
+typedef struct {
+  uint32_t timestamp_ms;     ///< `millis()` when the reading was taken
+  int16_t external_temp_raw; ///< External temperature in 1/8 degree C steps
+  uint16_t fan_rpm;          ///< Fan speed in RPM, 0 when stopped
+  int8_t internal_temp;      ///< Internal temperature in degrees C
+  uint8_t duty_raw;          ///< Raw 6-bit fan setting
+  uint8_t status;            ///< Status register, see `EMC2101_STATUS_*`
+} emc2101_sample_t;
+
+/**
+ * @brief Decimated readings, as produced by `summarize`
+ */
+typedef struct {
+  uint32_t first_ms;          ///< Timestamp of the oldest reading
+  uint32_t last_ms;           ///< Timestamp of the newest reading
+  uint8_t count;              ///< Number of readings summarized
+  int16_t external_temp_min;  ///< Lowest external temperature, 1/8 C
+  int16_t external_temp_max;  ///< Highest external temperature, 1/8 C
+  int16_t external_temp_mean; ///< Mean external temperature, 1/8 C
+  int8_t internal_temp_min;   ///< Lowest internal temperature, C
+  int8_t internal_temp_max;   ///< Highest internal temperature, C
+  int8_t internal_temp_mean;  ///< Mean internal temperature, C
+  uint16_t fan_rpm_min;       ///< Lowest fan speed
+  uint16_t fan_rpm_max;       ///< Highest fan speed
+  uint16_t fan_rpm_mean;      ///< Mean fan speed
+  uint8_t duty_raw_min;       ///< Lowest fan setting
+  uint8_t duty_raw_max;       ///< Highest fan setting
+  uint8_t duty_raw_mean;      ///< Mean fan setting
+  uint8_t status;             ///< All status bits seen, OR-ed together
+} emc2101_summary_t;
+
+/*!
+ *    @brief  Ring buffer of EMC2101 readings with one producer, which samples
+ *            the chip at its conversion rate, and one consumer, which may be
+ *            an interrupt handler or another core. Neither side locks.
+ *    @tparam CAPACITY Number of slots, 2-255. One slot is always kept empty
+ *            so `CAPACITY - 1` readings can be held
+ */
+template <uint8_t CAPACITY> class Adafruit_EMC2101_Telemetry {
+  static_assert((CAPACITY >= 2), "Telemetry needs at least 2 slots");
+
+public:
+  /**
+   * @brief Construct a new Adafruit_EMC2101_Telemetry
+   *
+   * @param emc2101 The chip to sample. It must already be started with
+   * `begin()`
+   */
+  Adafruit_EMC2101_Telemetry(Adafruit_EMC2101 *emc2101) { _emc2101 = emc2101; }
+
+  /**
+   * @brief Read the chip's data rate so samples are taken once per conversion.
+   * Call again after changing it with `setDataRate`
+   */
+  void begin(void) {
+    _period_ms = emc2101_rate_period_ms(_emc2101->getDataRate());
+    _started = false;
+  }
+
+  /**
+   * @brief Producer: take a reading if a new conversion is due. Readings are
+   * scheduled at fixed intervals, so calling this more often costs nothing
+   *
+   * @param now_ms The current time, usually from `millis()`
+   * @return true: a reading was stored false: not due, read failed, or full
+   */
+  bool sample(uint32_t now_ms) {
+    if (_started && ((int32_t)(now_ms - _next_ms) < 0)) {
+      return false;
+    }
+    _next_ms += _period_ms;
+    if (!_started || ((int32_t)(now_ms - _next_ms) >= 0)) {
+      _next_ms = now_ms + _period_ms;
+    }
+    _started = true;
+
+    emc2101_snapshot_t snapshot;
+    if (!_emc2101->readSnapshot(&snapshot)) {
+      return false;
+    }
+    emc2101_sample_t sample;
+    sample.timestamp_ms = now_ms;
+    sample.external_temp_raw = snapshot.external_temp_raw;
+    sample.fan_rpm = snapshot.fan_rpm;
+    sample.internal_temp = snapshot.internal_temp;
+    sample.duty_raw = snapshot.duty_raw;
+    sample.status = snapshot.status;
+    return push(&sample);
+  }
+
+  /**
+   * @brief Producer: store a reading. When the buffer is full the new reading
+   * is dropped and counted by `overruns`, since only the consumer may
+   * remove readings
+   *
+   * @param sample The reading to store
+   * @return true: stored false: the buffer was full
+   */
+  bool push(const emc2101_sample_t *sample) {
+    uint8_t head = _head;
+    uint8_t next = _next(head);
+    if (next == _tail) {
+      _overruns++;
+      return false;
+    }
+    _samples[head] = *sample;
+    EMC2101_MEMORY_BARRIER(); // the reading must land before it's published
+    _head = next;
+    return true;
+  }
+
+  /**
+   * @brief Consumer: remove the oldest reading
+   *
+   * @param sample Where to copy the reading
+   * @return true: a reading was removed false: the buffer was empty
+   */
+  bool pop(emc2101_sample_t *sample) {
+    uint8_t tail = _tail;
+    if (tail == _head) {
+      return false;
+    }
+    EMC2101_MEMORY_BARRIER(); // don't read the slot before seeing `_head`
+    *sample = _samples[tail];
+    EMC2101_MEMORY_BARRIER(); // finish the copy before freeing the slot
+    _tail = _next(tail);
+    return true;
+  }
+
+  /**
+   * @brief Get the number of readings waiting to be removed
+   *
+   * @return uint8_t The number of readings
+   */
+  uint8_t available(void) {
+    uint8_t head = _head, tail = _tail;
+    return (head >= tail) ? head - tail : CAPACITY - tail + head;
+  }
+
+  /**
+   * @brief Get the number of readings dropped because the buffer was full
+   *
+   * @return uint32_t The number of dropped readings
+   */
+  uint32_t overruns(void) { return _overruns; }
+
+  /**
+   * @brief Consumer: remove up to `count` readings and reduce them to their
+   * minimum, maximum and mean values, for sending over a slow link
+   *
+   * @param count The most readings to remove
+   * @param summary The summary to fill
+   * @return true: at least one reading was summarized false: buffer empty
+   */
+  bool summarize(uint8_t count, emc2101_summary_t *summary) {
+    emc2101_sample_t sample;
+    int32_t ext_total = 0, int_total = 0;
+    uint32_t rpm_total = 0, duty_total = 0;
+    uint8_t n = 0;
+
+    while ((n < count) && pop(&sample)) {
+      if (n == 0) {
+        summary->first_ms = sample.timestamp_ms;
+        summary->external_temp_min = summary->external_temp_max =
+            sample.external_temp_raw;
+        summary->internal_temp_min = summary->internal_temp_max =
+            sample.internal_temp;
+        summary->fan_rpm_min = summary->fan_rpm_max = sample.fan_rpm;
+        summary->duty_raw_min = summary->duty_raw_max = sample.duty_raw;
+        summary->status = 0;
+      }
+      summary->last_ms = sample.timestamp_ms;
+      summary->external_temp_min =
+          min(summary->external_temp_min, sample.external_temp_raw);
+      summary->external_temp_max =
+          max(summary->external_temp_max, sample.external_temp_raw);
+      summary->internal_temp_min =
+          min(summary->internal_temp_min, sample.internal_temp);
+      summary->internal_temp_max =
+          max(summary->internal_temp_max, sample.internal_temp);
+      summary->fan_rpm_min = min(summary->fan_rpm_min, sample.fan_rpm);
+      summary->fan_rpm_max = max(summary->fan_rpm_max, sample.fan_rpm);
+      summary->duty_raw_min = min(summary->duty_raw_min, sample.duty_raw);
+      summary->duty_raw_max = max(summary->duty_raw_max, sample.duty_raw);
+      summary->status |= sample.status;
+
+      ext_total += sample.external_temp_raw;
+      int_total += sample.internal_temp;
+      rpm_total += sample.fan_rpm;
+      duty_total += sample.duty_raw;
+      n++;
+    }
+    if (n == 0) {
+      return false;
+    }
+    summary->count = n;
+    summary->external_temp_mean = ext_total / n;
+    summary->internal_temp_mean = int_total / n;
+    summary->fan_rpm_mean = rpm_total / n;
+    summary->duty_raw_mean = duty_total / n;
+    return true;
+  }
+
+private:
+  /**
+   * @brief Advance a slot index
+   *
+   * @param index The current index
+   * @return uint8_t The following index, wrapping at `CAPACITY`
+   */
+  static uint8_t _next(uint8_t index) {
+    return (index + 1 == CAPACITY) ? 0 : index + 1;
+  }
+
+  Adafruit_EMC2101 *_emc2101;          ///< The chip being sampled
+  emc2101_sample_t _samples[CAPACITY]; ///< Storage for the readings
+  volatile uint8_t _head = 0; ///< Next slot to write, owned by the producer
+  volatile uint8_t _tail = 0; ///< Next slot to read, owned by the consumer
+  uint32_t _overruns = 0;     ///< Readings dropped because the buffer was full
+  uint16_t _period_ms = 0;    ///< Conversion period at the current data rate
+  uint32_t _next_ms = 0;      ///< When the next reading is due
+  bool _started = false;      ///< A reading has been scheduled
+};
+
+#endif
@@ -0,0 +1,180 @@
+/*!
+ *  @file Adafruit_EMC2101_Transport.cpp
+ *
+ * 	Bus transports for the EMC2101 driver: Adafruit BusIO on Arduino, and
+ * Linux /dev/i2c-N on Linux hosts
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101.h"
+
+#if defined(EMC2101_LINUX_HOST)
+
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/**
+ * @brief Construct a new, closed Adafruit_EMC2101_LinuxI2C
+ *
+ */
+Adafruit_EMC2101_LinuxI2C::Adafruit_EMC2101_LinuxI2C(void) {}
+
+/**
+ * @brief Close the bus device if it is open
+ *
+ */
+Adafruit_EMC2101_LinuxI2C::~Adafruit_EMC2101_LinuxI2C() { end(); }
+
+/**
+ * @brief Open a bus and check which transfers its adapter supports
+ *
+ * @param device The bus device, such as "/dev/i2c-1"
+ * @param i2c_addr The chip's I2C address
+ * @return true: success false: the device could not be opened or the address
+ * could not be selected
+ */
+bool Adafruit_EMC2101_LinuxI2C::begin(const char *device, uint8_t i2c_addr) {
+  end();
+  _fd = open(device, O_RDWR);
+  if (_fd < 0) {
+    return false;
+  }
+  _addr = i2c_addr;
+
+  unsigned long funcs = 0;
+  if (ioctl(_fd, I2C_FUNCS, &funcs) < 0) {
+    funcs = 0;
+  }
+  _use_rdwr = (funcs & I2C_FUNC_I2C) != 0;
+
+  // SMBus transfers are addressed with I2C_SLAVE
+  if (ioctl(_fd, I2C_SLAVE, (unsigned long)_addr) < 0) {
+    end();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Close the bus device
+ *
+ */
+void Adafruit_EMC2101_LinuxI2C::end(void) {
+  if (_fd >= 0) {
+    close(_fd);
+    _fd = -1;
+  }
+}
+
+/**
+ * @brief Read a single register with one ioctl
+ *
+ * @param reg_addr The register address
+ * @param value Where to store the register contents
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_LinuxI2C::read8(uint8_t reg_addr, uint8_t *value) {
+  if (_fd < 0) {
+    return false;
+  }
+  if (_use_rdwr) {
+    // register pointer write and data read with a repeated start
+    struct i2c_msg msgs[2] = {{_addr, 0, 1, &reg_addr},
+                              {_addr, I2C_M_RD, 1, value}};
+    struct i2c_rdwr_ioctl_data transfer = {msgs, 2};
+    return ioctl(_fd, I2C_RDWR, &transfer) == 2;
+  }
+
+  union i2c_smbus_data data;
+  struct i2c_smbus_ioctl_data args = {I2C_SMBUS_READ, reg_addr,
+                                      I2C_SMBUS_BYTE_DATA, &data};
+  if (ioctl(_fd, I2C_SMBUS, &args) < 0) {
+    return false;
+  }
+  *value = data.byte;
+  return true;
+}
+
+/**
+ * @brief Write a single register with one ioctl
+ *
+ * @param reg_addr The register address
+ * @param value The value to write
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_LinuxI2C::write8(uint8_t reg_addr, uint8_t value) {
+  if (_fd < 0) {
+    return false;
+  }
+  union i2c_smbus_data data;
+  data.byte = value;
+  struct i2c_smbus_ioctl_data args = {I2C_SMBUS_WRITE, reg_addr,
+                                      I2C_SMBUS_BYTE_DATA, &data};
+  return ioctl(_fd, I2C_SMBUS, &args) >= 0;
+}
+
+#else
+
+/**
+ * @brief Construct a new Adafruit_EMC2101_BusIOTransport
+ *
+ * @param i2c_dev The device to transfer with, or NULL to set it later with
+ * `setDevice`
+ */
+Adafruit_EMC2101_BusIOTransport::Adafruit_EMC2101_BusIOTransport(
+    Adafruit_I2CDevice *i2c_dev) {
+  _i2c_dev = i2c_dev;
+}
+
+/**
+ * @brief Set the device to transfer with
+ *
+ * @param i2c_dev The device, which must outlive this transport
+ */
+void Adafruit_EMC2101_BusIOTransport::setDevice(Adafruit_I2CDevice *i2c_dev) {
+  _i2c_dev = i2c_dev;
+}
+
+/**
+ * @brief Get the device this transport transfers with
+ *
+ * @return Adafruit_I2CDevice* The device, or NULL if none is set
+ */
+Adafruit_I2CDevice *Adafruit_EMC2101_BusIOTransport::device(void) {
+  return _i2c_dev;
+}
+
+/**
+ * @brief Read a single register
+ *
+ * @param reg_addr The register address
+ * @param value Where to store the register contents
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_BusIOTransport::read8(uint8_t reg_addr,
+                                            uint8_t *value) {
+  return _i2c_dev && _i2c_dev->write_then_read(&reg_addr, 1, value, 1);
+}
+
+/**
+ * @brief Write a single register
+ *
+ * @param reg_addr The register address
+ * @param value The value to write
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_BusIOTransport::write8(uint8_t reg_addr,
+                                             uint8_t value) {
+  uint8_t buffer[2] = {reg_addr, value};
+  return _i2c_dev && _i2c_dev->write(buffer, 2);
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*!
+ *  @file Adafruit_EMC2101_Transport.h
+ *
+ * 	Bus transports for the EMC2101 driver: Adafruit BusIO on Arduino, and
+ *Linux /dev/i2c-N on Linux hosts
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_EMC2101_TRANSPORT_H
+#define _ADAFRUIT_EMC2101_TRANSPORT_H
+
+/*!
+ *    @brief  Single register reads and writes to one EMC2101, the only bus
+ *            operations the chip supports. Implement this to run the driver
+ *            on another bus API
+ */
+class Adafruit_EMC2101_Transport {
+public:
+  virtual ~Adafruit_EMC2101_Transport() {}
+
+  /**
+   * @brief Read a single register
+   *
+   * @param reg_addr The register address
+   * @param value Where to store the register contents
+   * @return true: success false: failure
+   */
+  virtual bool read8(uint8_t reg_addr, uint8_t *value) = 0;
+
+  /**
+   * @brief Write a single register
+   *
+   * @param reg_addr The register address
+   * @param value The value to write
+   * @return true: success false: failure
+   */
+  virtual bool write8(uint8_t reg_addr, uint8_t value) = 0;
+};
+
+#if defined(EMC2101_LINUX_HOST)
+
+/*!
+ *    @brief  Transport for a Linux /dev/i2c-N bus. Register reads are a
+ *            single combined I2C_RDWR ioctl when the adapter supports plain
+ *            I2C, and an SMBus read byte data otherwise, such as on the
+ *            i2c-stub test module. Writes are an SMBus write byte data
+ */
+class Adafruit_EMC2101_LinuxI2C : public Adafruit_EMC2101_Transport {
+public:
+  Adafruit_EMC2101_LinuxI2C(void);
+  ~Adafruit_EMC2101_LinuxI2C();
+
+  bool begin(const char *device, uint8_t i2c_addr = 0x4C);
+  void end(void);
+
+  bool read8(uint8_t reg_addr, uint8_t *value) override;
+  bool write8(uint8_t reg_addr, uint8_t value) override;
+
+private:
+  int _fd = -1;           ///< The open bus device, -1 if closed
+  uint8_t _addr = 0;      ///< The chip's I2C address
+  bool _use_rdwr = false; ///< The adapter supports I2C_RDWR transfers
+};
+
+#else
+
+/*!
+ *    @brief  Transport for an Adafruit BusIO I2C device
+ */
+class Adafruit_EMC2101_BusIOTransport : public Adafruit_EMC2101_Transport {
+public:
+  Adafruit_EMC2101_BusIOTransport(Adafruit_I2CDevice *i2c_dev = NULL);
+
+  void setDevice(Adafruit_I2CDevice *i2c_dev);
+  Adafruit_I2CDevice *device(void);
+
+  bool read8(uint8_t reg_addr, uint8_t *value) override;
+  bool write8(uint8_t reg_addr, uint8_t value) override;
+
+private:
+  Adafruit_I2CDevice *_i2c_dev; ///< The device to transfer with
+};
+
+#endif
+
+#endif
@@ -0,0 +1,139 @@
+// Measures the bus cost of each Adafruit EMC2101 method at several I2C clock
+// speeds and prints the results as CSV (or JSON) so they can be compared
+// between library releases.
+//
+// Each method is called ITERATIONS times per clock speed. For each call the
+// sketch reports the register transfers and bus bytes it made, the time those
+// bytes take on the wire at that clock (9 clocks per byte with the ACK), and
+// the average measured time in microseconds. The difference between the last
+// two is the time spent outside the bus.
+//
+// If the library is built with EMC2101_INSTRUMENTATION defined to 1 (for
+// example with -DEMC2101_INSTRUMENTATION=1 in the board's build flags), the
+// per-method transfer counts and latency histograms are printed at the end.
+#include <Wire.h>
+#include <Adafruit_EMC2101.h>
+
+#define ITERATIONS 50
+// set to 1 to print the results as a JSON array instead of CSV
+#define OUTPUT_JSON 0
+
+Adafruit_EMC2101  emc2101;
+uint32_t i2c_hz = 100000;
+
+typedef void (*bench_fn_t)(void);
+
+typedef struct {
+  const char *name;
+  bench_fn_t fn;
+} bench_t;
+
+emc2101_lut_entry_t curve[] = {{20, 10}, {30, 25}, {40, 50}, {50, 75}, {60, 100}};
+
+bench_t benchmarks[] = {
+  // begin() restarts Wire at its default clock, so put the one under test back
+  {"begin", []() { emc2101.begin(); Wire.setClock(i2c_hz); }},
+  {"getInternalTemperature", []() { emc2101.getInternalTemperature(); }},
+  {"getExternalTemperature", []() { emc2101.getExternalTemperature(); }},
+  {"getFanRPM", []() { emc2101.getFanRPM(); }},
+  {"getDutyCycle", []() { emc2101.getDutyCycle(); }},
+  {"setDutyCycle", []() { emc2101.setDutyCycle(50); }},
+  {"setDutyCycleRaw", []() { emc2101.setDutyCycleRaw(32); }},
+  {"getFanMinRPM", []() { emc2101.getFanMinRPM(); }},
+  {"setFanMinRPM", []() { emc2101.setFanMinRPM(150); }},
+  {"getDataRate", []() { emc2101.getDataRate(); }},
+  {"setDataRate", []() { emc2101.setDataRate(EMC2101_RATE_32_HZ); }},
+  {"LUTEnabled", []() { emc2101.LUTEnabled(); }},
+  {"setLUT(index)", []() { emc2101.setLUT(0, 20, 10); }},
+  {"setLUT(entries)", []() { emc2101.setLUT(curve, 5); }},
+  {"getLUTHysteresis", []() { emc2101.getLUTHysteresis(); }},
+  {"setLUTHysteresis", []() { emc2101.setLUTHysteresis(4); }},
+  {"getPWMFrequency", []() { emc2101.getPWMFrequency(); }},
+  {"setPWMFrequency", []() { emc2101.setPWMFrequency(0x1F); }},
+  {"getPWMDivisor", []() { emc2101.getPWMDivisor(); }},
+  {"setPWMDivisor", []() { emc2101.setPWMDivisor(1); }},
+  {"configPWMClock", []() { emc2101.configPWMClock(1, 0); }},
+  {"configFanSpinup(drive time)", []() { emc2101.configFanSpinup(3, 5); }},
+  {"configFanSpinup(tach)", []() { emc2101.configFanSpinup(false); }},
+  {"DACOutEnabled", []() { emc2101.DACOutEnabled(); }},
+  {"enableForcedTemperature", []() { emc2101.enableForcedTemperature(false); }},
+  {"setForcedTemperature", []() { emc2101.setForcedTemperature(25); }},
+  {"getForcedTemperature", []() { emc2101.getForcedTemperature(); }},
+  {"enableTachInput", []() { emc2101.enableTachInput(true); }},
+  {"invertFanSpeed", []() { emc2101.invertFanSpeed(false); }},
+};
+
+uint32_t clock_speeds[] = {100000, 400000, 1000000};
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  if (!emc2101.begin()) {
+    Serial.println("Failed to find EMC2101 chip");
+    while (1) { delay(10); }
+  }
+
+#if OUTPUT_JSON
+  Serial.println("[");
+#else
+  Serial.println("method,i2c_hz,iterations,transfers_per_call,bytes_per_call,"
+                 "bus_us_per_call,us_per_call");
+#endif
+
+  bool first = true;
+  for (uint8_t c = 0; c < sizeof(clock_speeds) / sizeof(clock_speeds[0]); c++) {
+    i2c_hz = clock_speeds[c];
+    Wire.setClock(i2c_hz);
+
+    for (uint8_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+      emc2101_bus_stats_t before, after;
+      emc2101.getBusStats(&before);
+      uint32_t start = micros();
+      for (uint16_t i = 0; i < ITERATIONS; i++) {
+        benchmarks[b].fn();
+      }
+      uint32_t us_per_call = (micros() - start) / ITERATIONS;
+      emc2101.getBusStats(&after);
+      float transfers_per_call = (float)(after.transfers - before.transfers) / ITERATIONS;
+      float bytes_per_call = (float)(after.bytes - before.bytes) / ITERATIONS;
+      float bus_us_per_call = bytes_per_call * 9 * 1000000.0 / i2c_hz;
+
+#if OUTPUT_JSON
+      if (!first) Serial.println(",");
+      Serial.print("  {\"method\": \""); Serial.print(benchmarks[b].name);
+      Serial.print("\", \"i2c_hz\": "); Serial.print(clock_speeds[c]);
+      Serial.print(", \"iterations\": "); Serial.print(ITERATIONS);
+      Serial.print(", \"transfers_per_call\": "); Serial.print(transfers_per_call, 2);
+      Serial.print(", \"bytes_per_call\": "); Serial.print(bytes_per_call, 2);
+      Serial.print(", \"bus_us_per_call\": "); Serial.print(bus_us_per_call, 1);
+      Serial.print(", \"us_per_call\": "); Serial.print(us_per_call);
+      Serial.print("}");
+#else
+      Serial.print(benchmarks[b].name); Serial.print(",");
+      Serial.print(clock_speeds[c]); Serial.print(",");
+      Serial.print(ITERATIONS); Serial.print(",");
+      Serial.print(transfers_per_call, 2); Serial.print(",");
+      Serial.print(bytes_per_call, 2); Serial.print(",");
+      Serial.print(bus_us_per_call, 1); Serial.print(",");
+      Serial.println(us_per_call);
+#endif
+      first = false;
+    }
+  }
+
+#if OUTPUT_JSON
+  Serial.println();
+  Serial.println("]");
+#endif
+  Wire.setClock(100000);
+
+#if EMC2101_INSTRUMENTATION
+  Serial.println();
+  emc2101_instrumentation_dump(&Serial, OUTPUT_JSON);
+#endif
+}
+
+void loop() {
+  delay(1000);
+}
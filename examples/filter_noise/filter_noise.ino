@@ -0,0 +1,118 @@
+// Measures the external temperature noise for each of the EMC2101's digital
+// filter settings, and for averaging unfiltered readings in software, and
+// prints the results as CSV.
+//
+// Keep the external diode at a steady temperature while this runs. For each
+// setting SAMPLES values are taken, one per conversion, and the spread of
+// those values is reported along with how many register reads each value cost
+// and how long each value takes to produce. Failed reads are left out of the
+// values and counted in the read_errors column. The chip's filter doesn't cost
+// any extra reads, but it does make the reading lag a few conversions behind a
+// change in temperature, which a steady-state run like this can't show. The
+// test_filter_noise host test in extras/test measures that lag against the
+// simulated chip by stepping its temperature.
+#include <Wire.h>
+#include <Adafruit_EMC2101.h>
+
+#define SAMPLES 64
+#define SETTLE_CONVERSIONS 16
+
+Adafruit_EMC2101  emc2101;
+
+uint16_t period_ms;
+uint16_t read_errors;
+
+// Take one value, averaging `conversions` unfiltered readings when more than 1.
+// Failed reads are counted and left out, NAN if every read failed
+float takeValue(uint8_t conversions) {
+  int32_t sum = 0;
+  uint8_t readings = 0;
+  for (uint8_t i = 0; i < conversions; i++) {
+    emc2101.waitForConversion();
+    int16_t raw = emc2101.getExternalTemperatureRaw();
+    if (raw == EMC2101_TEMP_RAW_ERROR) {
+      read_errors++;
+      continue;
+    }
+    sum += raw;
+    readings++;
+  }
+  if (readings == 0) {
+    return NAN;
+  }
+  return (sum * 0.125) / readings;
+}
+
+void measure(const char *setting, uint8_t conversions) {
+  float values[SAMPLES];
+  float mean = 0, min_value = 1000, max_value = -1000;
+  uint8_t count = 0;
+
+  for (uint8_t i = 0; i < SETTLE_CONVERSIONS; i++) {
+    takeValue(1);
+  }
+  read_errors = 0;
+  for (uint8_t i = 0; i < SAMPLES; i++) {
+    float value = takeValue(conversions);
+    if (isnan(value)) {
+      continue;
+    }
+    values[count++] = value;
+    mean += value;
+    min_value = min(min_value, value);
+    max_value = max(max_value, value);
+  }
+  if (count == 0) {
+    Serial.print(setting); Serial.println(",no readings");
+    return;
+  }
+  mean /= count;
+
+  float variance = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    variance += (values[i] - mean) * (values[i] - mean);
+  }
+
+  Serial.print(setting); Serial.print(",");
+  Serial.print(conversions * 2); Serial.print(","); // MSB and LSB per reading
+  Serial.print(conversions * period_ms); Serial.print(",");
+  Serial.print(mean, 3); Serial.print(",");
+  Serial.print(sqrt(variance / count), 3); Serial.print(",");
+  Serial.print(max_value - min_value, 3); Serial.print(",");
+  Serial.println(read_errors);
+}
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  if (!emc2101.begin()) {
+    Serial.println("Failed to find EMC2101 chip");
+    while (1) { delay(10); }
+  }
+
+  emc2101.setDataRate(EMC2101_RATE_16_HZ);
+  period_ms = emc2101_rate_period_ms(EMC2101_RATE_16_HZ);
+  // read once per conversion, in step with the chip
+  emc2101.enableConversionTracking(true);
+  emc2101.syncToConversion(2 * period_ms);
+
+  Serial.println("setting,reads_per_value,ms_per_value,mean_c,stddev_c,p2p_c,read_errors");
+
+  emc2101.setFilter(EMC2101_FILTER_DISABLED);
+  measure("disabled", 1);
+  measure("software_avg_4", 4);
+  measure("software_avg_8", 8);
+
+  emc2101.setFilter(EMC2101_FILTER_LEVEL_1);
+  measure("level_1", 1);
+
+  emc2101.setFilter(EMC2101_FILTER_LEVEL_2);
+  measure("level_2", 1);
+
+  emc2101.setFilter(EMC2101_FILTER_DISABLED);
+}
+
+void loop() {
+  delay(1000);
+}
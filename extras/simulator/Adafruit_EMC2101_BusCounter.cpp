@@ -0,0 +1,127 @@
+/*!
+ *  @file Adafruit_EMC2101_BusCounter.cpp
+ *
+ * 	A transport that counts the transactions and bytes another transport
+ * carries, and estimates their time on the bus
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_BusCounter.h"
+
+/**
+ * @brief Construct a new Adafruit_EMC2101_BusCounter
+ *
+ * @param transport The transport to pass transfers on to
+ * @param clock_hz The bus clock speed for the time estimates
+ */
+Adafruit_EMC2101_BusCounter::Adafruit_EMC2101_BusCounter(
+    Adafruit_EMC2101_Transport *transport, uint32_t clock_hz) {
+  _transport = transport;
+  _clock_hz = clock_hz;
+}
+
+/**
+ * @brief Count and pass on a register read
+ *
+ * @param reg_addr The register address
+ * @param value Where to store the register contents
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_BusCounter::read8(uint8_t reg_addr, uint8_t *value) {
+  _reads++;
+  if (emc2101_host_clock()->simulated) {
+    delayMicroseconds(busMicros(EMC2101_BUS_READ_BYTES, _clock_hz));
+  }
+  return _transport->read8(reg_addr, value);
+}
+
+/**
+ * @brief Count and pass on a register write
+ *
+ * @param reg_addr The register address
+ * @param value The value to write
+ * @return true: success false: failure
+ */
+bool Adafruit_EMC2101_BusCounter::write8(uint8_t reg_addr, uint8_t value) {
+  _writes++;
+  if (emc2101_host_clock()->simulated) {
+    delayMicroseconds(busMicros(EMC2101_BUS_WRITE_BYTES, _clock_hz));
+  }
+  return _transport->write8(reg_addr, value);
+}
+
+/**
+ * @brief Set the bus clock speed used for the time estimates
+ *
+ * @param clock_hz The clock speed, such as 100000 or 400000
+ */
+void Adafruit_EMC2101_BusCounter::setClock(uint32_t clock_hz) {
+  _clock_hz = clock_hz;
+}
+
+/**
+ * @brief Zero the counters
+ *
+ */
+void Adafruit_EMC2101_BusCounter::reset(void) {
+  _reads = 0;
+  _writes = 0;
+}
+
+/**
+ * @brief Get the number of transactions, each a single register read or write
+ *
+ * @return uint32_t The transactions since the last `reset`
+ */
+uint32_t Adafruit_EMC2101_BusCounter::transactions(void) {
+  return _reads + _writes;
+}
+
+/**
+ * @brief Get the number of register reads
+ *
+ * @return uint32_t The reads since the last `reset`
+ */
+uint32_t Adafruit_EMC2101_BusCounter::reads(void) { return _reads; }
+
+/**
+ * @brief Get the number of register writes
+ *
+ * @return uint32_t The writes since the last `reset`
+ */
+uint32_t Adafruit_EMC2101_BusCounter::writes(void) { return _writes; }
+
+/**
+ * @brief Get the number of bytes on the bus, including addresses
+ *
+ * @return uint32_t The bytes since the last `reset`
+ */
+uint32_t Adafruit_EMC2101_BusCounter::bytes(void) {
+  return _reads * EMC2101_BUS_READ_BYTES + _writes * EMC2101_BUS_WRITE_BYTES;
+}
+
+/**
+ * @brief Estimate the bus time of the transactions counted
+ *
+ * @return uint32_t The time in microseconds at the clock set with `setClock`
+ */
+uint32_t Adafruit_EMC2101_BusCounter::busMicros(void) {
+  return busMicros(bytes(), _clock_hz);
+}
+
+/**
+ * @brief Estimate the bus time of a number of bytes
+ *
+ * @param bytes The bytes, including addresses
+ * @param clock_hz The bus clock speed
+ * @return uint32_t The time in microseconds, at 9 clocks per byte
+ */
+uint32_t Adafruit_EMC2101_BusCounter::busMicros(uint32_t bytes,
+                                                uint32_t clock_hz) {
+  return ((uint64_t)bytes * 9 * 1000000 + clock_hz - 1) / clock_hz;
+}
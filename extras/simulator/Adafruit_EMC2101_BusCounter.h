@@ -0,0 +1,53 @@
+/*!
+ *  @file Adafruit_EMC2101_BusCounter.h
+ *
+ * 	A transport that counts the transactions and bytes another transport
+ *carries, and estimates their time on the bus
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_EMC2101_BUSCOUNTER_H
+#define _ADAFRUIT_EMC2101_BUSCOUNTER_H
+
+#include "Adafruit_EMC2101.h"
+
+/*!
+ *    @brief  Passes transfers on to another transport and counts them. Each
+ *            byte is 9 clocks with its ACK, so the bus time at a clock speed
+ *            is estimated from the byte count, ignoring start and stop
+ *            conditions and clock stretching. With the simulated host clock,
+ *            each transfer also advances time by its estimate
+ */
+class Adafruit_EMC2101_BusCounter : public Adafruit_EMC2101_Transport {
+public:
+  Adafruit_EMC2101_BusCounter(Adafruit_EMC2101_Transport *transport,
+                              uint32_t clock_hz = 100000);
+
+  bool read8(uint8_t reg_addr, uint8_t *value) override;
+  bool write8(uint8_t reg_addr, uint8_t value) override;
+
+  void setClock(uint32_t clock_hz);
+  void reset(void);
+
+  uint32_t transactions(void);
+  uint32_t reads(void);
+  uint32_t writes(void);
+  uint32_t bytes(void);
+  uint32_t busMicros(void);
+
+  static uint32_t busMicros(uint32_t bytes, uint32_t clock_hz);
+
+private:
+  Adafruit_EMC2101_Transport *_transport; ///< Where transfers are passed on
+  uint32_t _clock_hz;                     ///< Clock used for the estimates
+  uint32_t _reads = 0;                    ///< Register reads
+  uint32_t _writes = 0;                   ///< Register writes
+};
+
+#endif
@@ -0,0 +1,545 @@
+/*!
+ *  @file Adafruit_EMC2101_Simulator.cpp
+ *
+ * 	A simulated EMC2101 and fan for running the driver on a Linux host without
+ * hardware, such as in CI
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_Simulator.h"
+
+#define SIM_LUT_DISABLE 0x20   ///< EMC2101_FAN_CONFIG: LUT disabled
+#define SIM_FORCE_TEMP 0x40    ///< EMC2101_FAN_CONFIG: LUT uses TEMP_FORCE
+#define SIM_INVERT 0x10        ///< EMC2101_FAN_CONFIG: polarity inverted
+#define SIM_SPINUP_TACH 0x20   ///< EMC2101_FAN_SPINUP: end on the tach limit
+#define SIM_STOPPED_RPM 83     ///< Slowest speed the tach count can represent
+#define SIM_TACH_CONST 5400000 ///< Tach count times RPM
+
+#define SIM_INT_HIGH_LIMIT 0x05     ///< Internal temperature high limit
+#define SIM_EXT_HIGH_LIMIT_MSB 0x07 ///< External high limit high byte
+#define SIM_EXT_LOW_LIMIT_MSB 0x08  ///< External low limit high byte
+#define SIM_EXT_HIGH_LIMIT_LSB 0x13 ///< External high limit low byte
+#define SIM_EXT_LOW_LIMIT_LSB 0x14  ///< External low limit low byte
+#define SIM_EXT_IDEALITY 0x17       ///< External diode ideality factor
+#define SIM_EXT_BETA_COMP 0x18      ///< External diode beta compensation
+#define SIM_TCRIT_LIMIT 0x19        ///< External temperature TCRIT limit
+#define SIM_TCRIT_HYSTERESIS 0x21   ///< Hysteresis of the TCRIT limit
+
+#define SIM_STATUS_BUSY 0x80     ///< EMC2101_STATUS: converting
+#define SIM_STATUS_INT_HIGH 0x40 ///< EMC2101_STATUS: internal above its limit
+#define SIM_STATUS_EXT_HIGH 0x10 ///< EMC2101_STATUS: external above its limit
+#define SIM_STATUS_EXT_LOW 0x08  ///< EMC2101_STATUS: external below its limit
+#define SIM_STATUS_TCRIT 0x02    ///< EMC2101_STATUS: external at TCRIT
+#define SIM_STATUS_TACH 0x01     ///< EMC2101_STATUS: tach count above limit
+
+/**
+ * @brief Construct a simulator with the default fan, in its power on state
+ *
+ */
+Adafruit_EMC2101_Simulator::Adafruit_EMC2101_Simulator(void) {
+  _fan = {3000, 20, 35, 400};
+  reset();
+}
+
+/**
+ * @brief Return the chip to its power on state, with the fan stopped. The
+ * environment set with `setExternalTemperature` and friends is kept
+ *
+ */
+void Adafruit_EMC2101_Simulator::reset(void) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  memset(_regs, 0, sizeof(_regs));
+  _regs[EMC2101_REG_DATA_RATE] = 0x08;
+  _regs[SIM_INT_HIGH_LIMIT] = 0x46;
+  _regs[SIM_EXT_HIGH_LIMIT_MSB] = 0x46;
+  _regs[SIM_TCRIT_LIMIT] = 0x55;
+  _regs[SIM_TCRIT_HYSTERESIS] = 0x0A;
+  _regs[SIM_EXT_IDEALITY] = 0x12;
+  _regs[SIM_EXT_BETA_COMP] = 0x08;
+  _regs[EMC2101_TACH_LIMIT_LSB] = 0xFF;
+  _regs[EMC2101_TACH_LIMIT_MSB] = 0xFF;
+  _regs[EMC2101_FAN_CONFIG] = SIM_LUT_DISABLE;
+  _regs[EMC2101_FAN_SPINUP] = 0x3F;
+  _regs[EMC2101_PWM_FREQ] = 0x17;
+  _regs[EMC2101_PWM_DIV] = 0x01;
+  _regs[EMC2101_LUT_HYSTERESIS] = 0x04;
+  for (uint8_t i = 0; i < 16; i += 2) {
+    _regs[EMC2101_LUT_START + i] = 0x7F;
+    _regs[EMC2101_LUT_START + i + 1] = 0x3F;
+  }
+  _regs[EMC2101_REG_PARTID] = EMC2101_CHIP_ID;
+  _regs[EMC2101_REG_MFGID] = 0x5D;
+  _regs[0xFF] = 0x01; // revision
+
+  _last_us = micros();
+  _now_us = 0;
+  _next_conv_us = 0;
+  _conversions = 0;
+  _filtered = _ext_temp;
+  _latched = 0;
+  _ext_pending = false;
+  _tach_pending = false;
+  _violations = 0;
+  _lut_index = -1;
+  _lut_setting = 0;
+  _rpm = 0;
+  _drive_percent = 0;
+  _last_setting = 0;
+  _spinup_end_us = 0;
+  _convert();
+}
+
+/**
+ * @brief Read a register, with the side effects the chip has on reads
+ *
+ * @param reg_addr The register address
+ * @param value Where to store the register contents
+ * @return true: success false: the simulated bus is failing
+ */
+bool Adafruit_EMC2101_Simulator::read8(uint8_t reg_addr, uint8_t *value) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  if (_failing) {
+    return false;
+  }
+  uint16_t tach;
+  switch (reg_addr) {
+  case EMC2101_EXTERNAL_TEMP_MSB:
+    if (_ext_pending) {
+      _violations++; // the previous LSB was never read
+    }
+    _ext_lsb_latch = _regs[EMC2101_EXTERNAL_TEMP_LSB];
+    _ext_pending = true;
+    *value = _regs[reg_addr];
+    break;
+  case EMC2101_EXTERNAL_TEMP_LSB:
+    if (!_ext_pending) {
+      _violations++; // may not match the MSB read before it
+      *value = _regs[reg_addr];
+    } else {
+      *value = _ext_lsb_latch;
+    }
+    _ext_pending = false;
+    break;
+  case EMC2101_TACH_LSB:
+    tach = _tach();
+    if (_tach_pending) {
+      _violations++;
+    }
+    _tach_msb_latch = tach >> 8;
+    _tach_pending = true;
+    *value = tach & 0xFF;
+    break;
+  case EMC2101_TACH_MSB:
+    if (!_tach_pending) {
+      _violations++;
+      *value = _tach() >> 8;
+    } else {
+      *value = _tach_msb_latch;
+    }
+    _tach_pending = false;
+    break;
+  case EMC2101_STATUS:
+    *value = _latched;
+    if ((_next_conv_us - _now_us) <= EMC2101_SIM_BUSY_US) {
+      *value |= SIM_STATUS_BUSY;
+    }
+    _latched = _conditions(); // reading clears bits whose cause has gone
+    break;
+  case EMC2101_REG_FAN_SETTING:
+    *value = _fanSetting();
+    break;
+  default:
+    *value = _regs[reg_addr];
+  }
+  return true;
+}
+
+/**
+ * @brief Write a register. Writes to read-only registers, and to the fan
+ * setting and LUT while the LUT is enabled, are acknowledged but ignored like
+ * on the chip
+ *
+ * @param reg_addr The register address
+ * @param value The value to write
+ * @return true: success false: the simulated bus is failing
+ */
+bool Adafruit_EMC2101_Simulator::write8(uint8_t reg_addr, uint8_t value) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  if (_failing) {
+    return false;
+  }
+  bool lut_enabled = !(_regs[EMC2101_FAN_CONFIG] & SIM_LUT_DISABLE);
+  switch (reg_addr) {
+  case EMC2101_INTERNAL_TEMP:
+  case EMC2101_EXTERNAL_TEMP_MSB:
+  case EMC2101_STATUS:
+  case EMC2101_EXTERNAL_TEMP_LSB:
+  case EMC2101_TACH_LSB:
+  case EMC2101_TACH_MSB:
+  case EMC2101_REG_PARTID:
+  case EMC2101_REG_MFGID:
+  case 0xFF:
+    return true;
+  case EMC2101_REG_FAN_SETTING:
+    if (!lut_enabled) {
+      _regs[reg_addr] = value & 0x3F;
+      _checkSpinup();
+    }
+    return true;
+  case EMC2101_FAN_CONFIG:
+    if (lut_enabled && (value & SIM_LUT_DISABLE)) {
+      // the fan setting register keeps the LUT's last choice
+      _regs[EMC2101_REG_FAN_SETTING] = _lut_setting;
+    } else if (!lut_enabled && !(value & SIM_LUT_DISABLE)) {
+      // the LUT holds the current setting until its first conversion
+      _lut_index = -1;
+      _lut_setting = _regs[EMC2101_REG_FAN_SETTING];
+    }
+    _regs[reg_addr] = value;
+    _checkSpinup();
+    return true;
+  default:
+    if (lut_enabled && (reg_addr >= EMC2101_LUT_START) &&
+        (reg_addr < EMC2101_LUT_START + 16)) {
+      return true;
+    }
+    _regs[reg_addr] = value;
+    return true;
+  }
+}
+
+/**
+ * @brief Set the temperature of the simulated external diode
+ *
+ * @param temp_c The temperature in degrees C
+ */
+void Adafruit_EMC2101_Simulator::setExternalTemperature(float temp_c) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  _ext_temp = temp_c;
+}
+
+/**
+ * @brief Set the temperature of the simulated chip
+ *
+ * @param temp_c The temperature in degrees C
+ */
+void Adafruit_EMC2101_Simulator::setInternalTemperature(int8_t temp_c) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  _int_temp = temp_c;
+}
+
+/**
+ * @brief Add gaussian noise to the external temperature conversions. The noise
+ * is pseudo-random from a fixed seed so runs are repeatable
+ *
+ * @param stddev_c The standard deviation in degrees C, 0 for none
+ */
+void Adafruit_EMC2101_Simulator::setNoise(float stddev_c) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  _noise = stddev_c;
+}
+
+/**
+ * @brief Replace the fan model. The fan keeps its current speed
+ *
+ * @param fan The new model
+ */
+void Adafruit_EMC2101_Simulator::setFan(const emc2101_sim_fan_t *fan) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  _fan = *fan;
+}
+
+/**
+ * @brief Make every transfer fail, like a chip that stopped acknowledging
+ *
+ * @param failing true to fail transfers, false to answer them again
+ */
+void Adafruit_EMC2101_Simulator::setFailing(bool failing) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _failing = failing;
+}
+
+/**
+ * @brief Read a register's contents without the side effects of a bus read
+ *
+ * @param reg_addr The register address
+ * @return uint8_t The register contents
+ */
+uint8_t Adafruit_EMC2101_Simulator::peek(uint8_t reg_addr) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  return _regs[reg_addr];
+}
+
+/**
+ * @brief Change a register's contents directly, even a read-only one
+ *
+ * @param reg_addr The register address
+ * @param value The new contents
+ */
+void Adafruit_EMC2101_Simulator::poke(uint8_t reg_addr, uint8_t value) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  _regs[reg_addr] = value;
+}
+
+/**
+ * @brief Get the actual speed of the simulated fan
+ *
+ * @return uint16_t The speed in RPM
+ */
+uint16_t Adafruit_EMC2101_Simulator::fanRPM(void) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  return (uint16_t)(_rpm + 0.5f);
+}
+
+/**
+ * @brief Get the drive applied to the fan, including spin-up and inversion
+ *
+ * @return uint8_t The drive in percent
+ */
+uint8_t Adafruit_EMC2101_Simulator::fanDrivePercent(void) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  return _drive_percent;
+}
+
+/**
+ * @brief Get the number of temperature conversions completed
+ *
+ * @return uint32_t The conversions since the last `reset`
+ */
+uint32_t Adafruit_EMC2101_Simulator::conversionCount(void) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  _update();
+  return _conversions;
+}
+
+/**
+ * @brief Get the number of times an interlocked pair was read out of order:
+ * the second register without the first, or the first twice in a row. Either
+ * way the reading may be torn
+ *
+ * @return uint32_t The violations since the last `reset`
+ */
+uint32_t Adafruit_EMC2101_Simulator::interlockViolations(void) {
+  std::lock_guard<std::recursive_mutex> guard(_mutex);
+  return _violations;
+}
+
+/**
+ * @brief Advance the model to the current `micros()`, stepping the fan and
+ * completing conversions as they fall due
+ *
+ */
+void Adafruit_EMC2101_Simulator::_update(void) {
+  uint32_t now = micros();
+  uint64_t end = _now_us + (uint32_t)(now - _last_us);
+  _last_us = now;
+  while (_now_us < end) {
+    uint32_t step_us = min(end - _now_us, (uint64_t)EMC2101_SIM_STEP_US);
+    _now_us += step_us;
+    _step(step_us);
+    while (_now_us >= _next_conv_us) {
+      _convert();
+    }
+  }
+}
+
+/**
+ * @brief Start a spin-up if the fan output has just left 0. Called whenever
+ * the output may have changed, so a change is seen even if no time passes
+ * before the next one
+ *
+ * @return uint8_t The fan output, 0-63, after any inversion
+ */
+uint8_t Adafruit_EMC2101_Simulator::_checkSpinup(void) {
+  uint8_t setting = _fanSetting();
+  if (_regs[EMC2101_FAN_CONFIG] & SIM_INVERT) {
+    setting = MAX_LUT_SPEED - setting;
+  }
+  uint8_t spinup = _regs[EMC2101_FAN_SPINUP];
+  uint8_t drive_bits = (spinup >> 3) & 0x03;
+  uint8_t time_bits = spinup & 0x07;
+  if ((_last_setting == 0) && (setting != 0) && drive_bits && time_bits) {
+    _spinup_end_us = _now_us + (25000UL << time_bits);
+  }
+  _last_setting = setting;
+  return setting;
+}
+
+/**
+ * @brief Move the fan on by one time step
+ *
+ * @param step_us The length of the step
+ */
+void Adafruit_EMC2101_Simulator::_step(uint32_t step_us) {
+  uint8_t setting = _checkSpinup();
+  uint8_t spinup = _regs[EMC2101_FAN_SPINUP];
+  uint8_t drive_bits = (spinup >> 3) & 0x03;
+  uint8_t percent = ((uint16_t)setting * 100) / MAX_LUT_SPEED;
+  if (_spinup_end_us) {
+    uint16_t limit = (_regs[EMC2101_TACH_LIMIT_MSB] << 8) |
+                     _regs[EMC2101_TACH_LIMIT_LSB];
+    if ((setting == 0) || (_now_us >= _spinup_end_us) ||
+        ((spinup & SIM_SPINUP_TACH) && (_tach() <= limit))) {
+      _spinup_end_us = 0;
+    } else {
+      percent = 25 + 25 * drive_bits; // 50, 75 or 100%
+    }
+  }
+  _drive_percent = percent;
+
+  // a stopped fan needs more drive to start than a turning one to keep going
+  float catch_rpm = 0.8f * _fan.max_rpm * _fan.stall_percent / 100;
+  bool turning = (percent >= _fan.start_percent) ||
+                 ((percent >= _fan.stall_percent) && (_rpm >= catch_rpm));
+  float target = turning ? (float)_fan.max_rpm * percent / 100 : 0;
+  float tau_us = max(_fan.tau_ms, (uint16_t)1) * 1000.0f;
+  _rpm += (target - _rpm) * min(step_us / tau_us, 1.0f);
+}
+
+/**
+ * @brief Complete a conversion: update the temperature registers, evaluate
+ * the LUT and latch the status conditions, then schedule the next one
+ *
+ */
+void Adafruit_EMC2101_Simulator::_convert(void) {
+  uint8_t rate = min(_regs[EMC2101_REG_DATA_RATE] & 0x0F, EMC2101_RATE_32_HZ);
+  _next_conv_us += 16000000UL >> rate;
+  _conversions++;
+
+  float reading = _ext_temp;
+  if (_noise > 0) {
+    reading += _noise * _gaussian();
+  }
+  switch ((_regs[EMC2101_TEMP_FILTER] >> 1) & 0x03) {
+  case 0:
+    _filtered = reading;
+    break;
+  case 1:
+    _filtered += (reading - _filtered) / 2;
+    break;
+  default:
+    _filtered += (reading - _filtered) / 4;
+  }
+  long raw = lroundf(_filtered * 8); // 0.125 degree steps
+  raw = constrain(raw, -64L * 8, 127L * 8 + 7);
+  _regs[EMC2101_EXTERNAL_TEMP_MSB] = (uint8_t)(raw >> 3);
+  _regs[EMC2101_EXTERNAL_TEMP_LSB] = (raw & 0x07) << 5;
+  _regs[EMC2101_INTERNAL_TEMP] = (uint8_t)_int_temp;
+
+  if (!(_regs[EMC2101_FAN_CONFIG] & SIM_LUT_DISABLE)) {
+    int8_t temp = (_regs[EMC2101_FAN_CONFIG] & SIM_FORCE_TEMP)
+                      ? (int8_t)_regs[EMC2101_TEMP_FORCE]
+                      : (int8_t)_regs[EMC2101_EXTERNAL_TEMP_MSB];
+    int8_t index = -1;
+    for (int8_t i = 0; i < 8; i++) {
+      if (temp >= _regs[EMC2101_LUT_START + i * 2]) {
+        index = i;
+      }
+    }
+    if (index < _lut_index) {
+      // falling: an entry is only left once below its threshold less the
+      // hysteresis
+      uint8_t hyst = _regs[EMC2101_LUT_HYSTERESIS];
+      for (int8_t i = index + 1; i <= _lut_index; i++) {
+        if (temp + hyst >= _regs[EMC2101_LUT_START + i * 2]) {
+          index = i;
+        }
+      }
+    }
+    _lut_index = index;
+    _lut_setting =
+        (index < 0) ? 0 : _regs[EMC2101_LUT_START + index * 2 + 1] & 0x3F;
+  }
+
+  _checkSpinup();
+  _latched |= _conditions();
+}
+
+/**
+ * @brief Get the fan setting in force, from the LUT when it is enabled
+ *
+ * @return uint8_t The setting, 0-63
+ */
+uint8_t Adafruit_EMC2101_Simulator::_fanSetting(void) {
+  if (!(_regs[EMC2101_FAN_CONFIG] & SIM_LUT_DISABLE)) {
+    return _lut_setting;
+  }
+  return _regs[EMC2101_REG_FAN_SETTING] & 0x3F;
+}
+
+/**
+ * @brief Get the tach count for the current fan speed
+ *
+ * @return uint16_t The count, 0xFFFF when stopped
+ */
+uint16_t Adafruit_EMC2101_Simulator::_tach(void) {
+  if (_rpm < SIM_STOPPED_RPM) {
+    return 0xFFFF;
+  }
+  return min((uint32_t)(SIM_TACH_CONST / _rpm), (uint32_t)0xFFFE);
+}
+
+/**
+ * @brief Get the status bits whose conditions hold right now
+ *
+ * @return uint8_t The status bits, without BUSY
+ */
+uint8_t Adafruit_EMC2101_Simulator::_conditions(void) {
+  uint8_t status = 0;
+  if ((int8_t)_regs[EMC2101_INTERNAL_TEMP] >
+      (int8_t)_regs[SIM_INT_HIGH_LIMIT]) {
+    status |= SIM_STATUS_INT_HIGH;
+  }
+  int16_t ext = ((int8_t)_regs[EMC2101_EXTERNAL_TEMP_MSB] * 8) |
+                (_regs[EMC2101_EXTERNAL_TEMP_LSB] >> 5);
+  int16_t high = ((int8_t)_regs[SIM_EXT_HIGH_LIMIT_MSB] * 8) |
+                 (_regs[SIM_EXT_HIGH_LIMIT_LSB] >> 5);
+  int16_t low = ((int8_t)_regs[SIM_EXT_LOW_LIMIT_MSB] * 8) |
+                (_regs[SIM_EXT_LOW_LIMIT_LSB] >> 5);
+  if (ext > high) {
+    status |= SIM_STATUS_EXT_HIGH;
+  }
+  if (ext < low) {
+    status |= SIM_STATUS_EXT_LOW;
+  }
+  if ((int8_t)_regs[EMC2101_EXTERNAL_TEMP_MSB] >=
+      (int8_t)_regs[SIM_TCRIT_LIMIT]) {
+    status |= SIM_STATUS_TCRIT;
+  }
+  uint16_t limit =
+      (_regs[EMC2101_TACH_LIMIT_MSB] << 8) | _regs[EMC2101_TACH_LIMIT_LSB];
+  if (_tach() > limit) {
+    status |= SIM_STATUS_TACH;
+  }
+  return status;
+}
+
+/**
+ * @brief Get a sample of unit gaussian noise from a fixed-seed generator
+ *
+ * @return float The sample
+ */
+float Adafruit_EMC2101_Simulator::_gaussian(void) {
+  // the sum of 12 uniform samples is close enough to gaussian
+  float sum = 0;
+  for (uint8_t i = 0; i < 12; i++) {
+    _random = _random * 1664525UL + 1013904223UL;
+    sum += (_random >> 8) / 16777216.0f;
+  }
+  return sum - 6;
+}
@@ -0,0 +1,117 @@
+/*!
+ *  @file Adafruit_EMC2101_Simulator.h
+ *
+ * 	A simulated EMC2101 and fan for running the driver on a Linux host without
+ *hardware, such as in CI
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_EMC2101_SIMULATOR_H
+#define _ADAFRUIT_EMC2101_SIMULATOR_H
+
+#include "Adafruit_EMC2101.h"
+#include <mutex>
+
+#define EMC2101_SIM_BUSY_US 4000 ///< Time the BUSY bit is set per conversion
+#define EMC2101_SIM_STEP_US 1000 ///< Time step of the fan model
+
+/**
+ * @brief How the simulated fan responds to its drive. A turning fan keeps
+ * turning down to `stall_percent`, but a stopped fan needs `start_percent`, or
+ * a spin-up that gets it close to its stall speed, to start
+ */
+typedef struct {
+  uint16_t max_rpm;      ///< Speed at full drive
+  uint8_t stall_percent; ///< A turning fan stops below this drive
+  uint8_t start_percent; ///< Drive needed to start a stopped fan
+  uint16_t tau_ms;       ///< Time constant of the speed response
+} emc2101_sim_fan_t;
+
+/*!
+ *    @brief  A register-level model of an EMC2101 and the fan attached to it,
+ *            used as the driver's transport. Time comes from `micros()`, so
+ *            with the simulated host clock the model only advances when the
+ *            code under test waits.
+ *
+ *            The model covers the register map with its power on defaults,
+ *            conversions at the data rate with the BUSY bit and digital
+ *            filter, the external temperature and tach 'Data Read Interlock'
+ *            pairs, latched status bits, the LUT with hysteresis and forced
+ *            temperature, spin-up and the fan speed. While the LUT is enabled
+ *            the fan setting register reads back the LUT's choice, and writes
+ *            to it and to the LUT are ignored.
+ *
+ *            Transfers are serialized like a real bus, so several threads can
+ *            share one simulator.
+ */
+class Adafruit_EMC2101_Simulator : public Adafruit_EMC2101_Transport {
+public:
+  Adafruit_EMC2101_Simulator(void);
+
+  void reset(void);
+
+  bool read8(uint8_t reg_addr, uint8_t *value) override;
+  bool write8(uint8_t reg_addr, uint8_t value) override;
+
+  void setExternalTemperature(float temp_c);
+  void setInternalTemperature(int8_t temp_c);
+  void setNoise(float stddev_c);
+  void setFan(const emc2101_sim_fan_t *fan);
+  void setFailing(bool failing);
+
+  uint8_t peek(uint8_t reg_addr);
+  void poke(uint8_t reg_addr, uint8_t value);
+  uint16_t fanRPM(void);
+  uint8_t fanDrivePercent(void);
+  uint32_t conversionCount(void);
+  uint32_t interlockViolations(void);
+
+private:
+  void _update(void);
+  uint8_t _checkSpinup(void);
+  void _step(uint32_t step_us);
+  void _convert(void);
+  uint8_t _fanSetting(void);
+  uint16_t _tach(void);
+  uint8_t _conditions(void);
+  float _gaussian(void);
+
+  std::recursive_mutex _mutex; ///< Serializes transfers, like a real bus
+
+  uint8_t _regs[256];         ///< Register contents
+  bool _failing = false;      ///< Every transfer fails
+  uint32_t _last_us = 0;      ///< `micros()` when the model last advanced
+  uint64_t _now_us = 0;       ///< Time since reset
+  uint64_t _next_conv_us = 0; ///< When the next conversion completes
+  uint32_t _conversions = 0;  ///< Conversions completed since reset
+
+  float _ext_temp = 25;  ///< Actual external diode temperature
+  int8_t _int_temp = 25; ///< Actual internal temperature
+  float _noise = 0;      ///< Standard deviation of external readings
+  float _filtered = 25;  ///< Digital filter state
+  uint32_t _random = 1;  ///< Noise generator state
+  uint8_t _latched = 0;  ///< Latched status bits
+
+  uint8_t _ext_lsb_latch = 0;  ///< LSB latched by reading the MSB
+  bool _ext_pending = false;   ///< The external temperature LSB is due
+  uint8_t _tach_msb_latch = 0; ///< MSB latched by reading the LSB
+  bool _tach_pending = false;  ///< The tach MSB is due
+  uint32_t _violations = 0;    ///< Interlock pairs read out of order
+
+  int8_t _lut_index = -1;   ///< LUT entry in use, -1 for none
+  uint8_t _lut_setting = 0; ///< Fan setting chosen by the LUT
+
+  emc2101_sim_fan_t _fan;      ///< The fan model
+  float _rpm = 0;              ///< Fan speed
+  uint8_t _drive_percent = 0;  ///< Drive applied on the last step
+  uint8_t _last_setting = 0;   ///< Fan setting on the last step
+  uint64_t _spinup_end_us = 0; ///< When the running spin-up ends, 0 if none
+};
+
+#endif
@@ -0,0 +1,41 @@
+/*!
+ *  @file emc2101_test.h
+ *
+ * 	Minimal checks for the host tests in extras/test. Each test is a program
+ *that prints what it measured and exits non-zero if any check failed
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _EMC2101_TEST_H
+#define _EMC2101_TEST_H
+
+#include <stdio.h>
+
+static int emc2101_test_failures = 0; ///< Checks failed so far
+
+/**
+ * @brief Check a condition, printing it with its location if it is false
+ */
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);     \
+      emc2101_test_failures++;                                                 \
+    }                                                                          \
+  } while (0)
+
+/**
+ * @brief Return from `main` with the test result
+ */
+#define TEST_RESULT()                                                          \
+  ((emc2101_test_failures == 0)                                                \
+       ? (printf("PASS\n"), 0)                                                 \
+       : (printf("FAIL: %d checks\n", emc2101_test_failures), 1))
+
+#endif
@@ -0,0 +1,82 @@
+/*!
+ *  @file test_async_snapshot.cpp
+ *
+ * 	Interleaves blocking reads with a snapshot read by `poll()` without a bus
+ * lock, and checks no 'Data Read Interlock' pair is broken
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+
+static void poll_steps(Adafruit_EMC2101 *emc, uint8_t steps) {
+  for (uint8_t i = 0; i < steps; i++) {
+    CHECK(emc->poll() == EMC2101_ASYNC_IN_PROGRESS);
+  }
+}
+
+static emc2101_async_status_t poll_done(Adafruit_EMC2101 *emc) {
+  emc2101_async_status_t status;
+  while ((status = emc->poll()) == EMC2101_ASYNC_IN_PROGRESS) {
+  }
+  return status;
+}
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  sim.setExternalTemperature(42.625);
+  CHECK(emc.setDutyCycle(100));
+  delay(3000);
+  emc2101_snapshot_t snapshot;
+
+  // a blocking read between the external temperature MSB and LSB
+  CHECK(emc.startSnapshot(&snapshot));
+  poll_steps(&emc, 2);
+  CHECK(emc.getExternalTemperature() == 42.625f);
+  CHECK(emc.getFanRPM() > 2900);
+  CHECK(poll_done(&emc) == EMC2101_ASYNC_DONE);
+  CHECK(snapshot.external_temp == 42.625f);
+  CHECK(snapshot.fan_rpm > 2900);
+  CHECK(sim.interlockViolations() == 0);
+
+  // and between the tach LSB and MSB
+  CHECK(emc.startSnapshot(&snapshot));
+  poll_steps(&emc, 5);
+  emc2101_snapshot_t blocking;
+  CHECK(emc.readSnapshot(&blocking));
+  CHECK(poll_done(&emc) == EMC2101_ASYNC_DONE);
+  CHECK(snapshot.fan_rpm == blocking.fan_rpm);
+  CHECK(sim.interlockViolations() == 0);
+
+  // cancelling inside a pair finishes it
+  CHECK(emc.startSnapshot(&snapshot));
+  poll_steps(&emc, 2);
+  CHECK(emc.cancelSnapshot());
+  CHECK(emc.poll() == EMC2101_ASYNC_IDLE);
+  CHECK(emc.getExternalTemperature() == 42.625f);
+  CHECK(sim.interlockViolations() == 0);
+  CHECK(emc.startSnapshot(&snapshot));
+  CHECK(poll_done(&emc) == EMC2101_ASYNC_DONE);
+
+  // an alert latched while syncing shows up in the next snapshot, once
+  CHECK(emc.setExternalTempHighLimit(40));
+  sim.setExternalTemperature(45);
+  delay(100);
+  sim.setExternalTemperature(30);
+  delay(100);
+  CHECK(emc.syncToConversion(500));
+  CHECK(emc.startSnapshot(&snapshot));
+  CHECK(poll_done(&emc) == EMC2101_ASYNC_DONE);
+  CHECK(snapshot.status & EMC2101_STATUS_EXT_HIGH);
+  CHECK(emc.readSnapshot(&blocking));
+  CHECK(!(blocking.status & EMC2101_STATUS_EXT_HIGH));
+  return TEST_RESULT();
+}
@@ -0,0 +1,133 @@
+/*!
+ *  @file test_bus_cost.cpp
+ *
+ * 	Counts the transactions and bytes each public method puts on the bus,
+ * prints them with their estimated bus time at 100 kHz, 400 kHz and 1 MHz,
+ * and fails if a method needs more transactions than its budget. Pass --json
+ * to print JSON instead of CSV
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_BusCounter.h"
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+#include <string.h>
+
+#define ITERATIONS 10 ///< Calls per method, after a fresh begin
+
+static Adafruit_EMC2101 emc;
+static Adafruit_EMC2101_BusCounter *bus; ///< What `begin` connects to
+
+static const emc2101_lut_entry_t curve[] = {
+    {20, 10}, {30, 25}, {40, 50}, {50, 75}, {60, 100}};
+
+/**
+ * @brief A method to measure, with the most transactions one call may take
+ */
+typedef struct {
+  const char *name;      ///< Shown in the results
+  void (*fn)(void);      ///< Makes one call
+  uint8_t max_transfers; ///< Budget for the most expensive call
+} bench_t;
+
+static const bench_t benchmarks[] = {
+    {"begin", []() { emc.begin(bus); }, 7},
+    {"getInternalTemperature", []() { emc.getInternalTemperature(); }, 1},
+    {"getExternalTemperature", []() { emc.getExternalTemperature(); }, 2},
+    {"readSnapshot",
+     []() {
+       emc2101_snapshot_t snapshot;
+       emc.readSnapshot(&snapshot);
+     },
+     7},
+    {"getFanRPM", []() { emc.getFanRPM(); }, 2},
+    {"getDutyCycle", []() { emc.getDutyCycle(); }, 1},
+    {"setDutyCycle", []() { emc.setDutyCycle(50); }, 1},
+    {"setDutyCycleRaw", []() { emc.setDutyCycleRaw(32); }, 1},
+    {"getFanMinRPM", []() { emc.getFanMinRPM(); }, 2},
+    {"setFanMinRPM", []() { emc.setFanMinRPM(150); }, 2},
+    {"getDataRate", []() { emc.getDataRate(); }, 1},
+    {"setDataRate", []() { emc.setDataRate(EMC2101_RATE_32_HZ); }, 2},
+    {"LUTEnabled", []() { emc.LUTEnabled(); }, 1},
+    {"setLUT(index)", []() { emc.setLUT(0, 20, 10); }, 7},
+    {"setLUT(entries)", []() { emc.setLUT(curve, 5); }, 21},
+    {"getLUTHysteresis", []() { emc.getLUTHysteresis(); }, 1},
+    {"setLUTHysteresis", []() { emc.setLUTHysteresis(4); }, 1},
+    {"setPWMFrequency", []() { emc.setPWMFrequency(0x1F); }, 1},
+    {"setPWMDivisor", []() { emc.setPWMDivisor(1); }, 1},
+    {"configPWMClock", []() { emc.configPWMClock(1, 0); }, 2},
+    {"configFanSpinup(drive time)", []() { emc.configFanSpinup(3, 5); }, 2},
+    {"configFanSpinup(tach)", []() { emc.configFanSpinup(false); }, 2},
+    {"setForcedTemperature", []() { emc.setForcedTemperature(25); }, 1},
+    {"enableForcedTemperature",
+     []() { emc.enableForcedTemperature(false); },
+     2},
+    {"enableTachInput", []() { emc.enableTachInput(true); }, 2},
+    {"invertFanSpeed", []() { emc.invertFanSpeed(false); }, 2},
+};
+
+static const uint32_t clock_speeds[] = {100000, 400000, 1000000};
+
+int main(int argc, char **argv) {
+  emc2101_host_clock()->simulated = true;
+  bool json = (argc > 1) && (strcmp(argv[1], "--json") == 0);
+  bool first = true;
+
+  printf(json ? "[\n"
+              : "method,i2c_hz,iterations,transfers_per_call,bytes_per_call,"
+                "bus_us_per_call,max_transfers\n");
+  for (const uint32_t &clock_hz : clock_speeds) {
+    for (const bench_t &bench : benchmarks) {
+      Adafruit_EMC2101_Simulator sim;
+      Adafruit_EMC2101_BusCounter counter(&sim, clock_hz);
+      bus = &counter;
+      CHECK(emc.begin(bus));
+
+      uint32_t max_transfers = 0;
+      bus->reset();
+      emc.resetBusStats();
+      for (uint8_t i = 0; i < ITERATIONS; i++) {
+        uint32_t before = bus->transactions();
+        bench.fn();
+        if (bus->transactions() - before > max_transfers) {
+          max_transfers = bus->transactions() - before;
+        }
+      }
+      // the driver's own counters, as a sketch on the target sees them
+      emc2101_bus_stats_t stats;
+      emc.getBusStats(&stats);
+      CHECK(stats.transfers == bus->transactions());
+      CHECK(stats.bytes == bus->bytes());
+
+      float transfers = (float)bus->transactions() / ITERATIONS;
+      float bytes = (float)bus->bytes() / ITERATIONS;
+      float bus_us = (float)bus->busMicros() / ITERATIONS;
+
+      if (json) {
+        printf("%s  {\"method\": \"%s\", \"i2c_hz\": %u, \"iterations\": %u, "
+               "\"transfers_per_call\": %.2f, \"bytes_per_call\": %.2f, "
+               "\"bus_us_per_call\": %.1f, \"max_transfers\": %u}",
+               first ? "" : ",\n", bench.name, (unsigned)clock_hz,
+               ITERATIONS, transfers, bytes, bus_us, (unsigned)max_transfers);
+      } else {
+        printf("%s,%u,%u,%.2f,%.2f,%.1f,%u\n", bench.name, (unsigned)clock_hz,
+               ITERATIONS, transfers, bytes, bus_us, (unsigned)max_transfers);
+      }
+      first = false;
+      if (max_transfers > bench.max_transfers) {
+        printf("%s: %u transfers, budget %u\n", bench.name,
+               (unsigned)max_transfers, bench.max_transfers);
+        CHECK(max_transfers <= bench.max_transfers);
+      }
+    }
+  }
+  if (json) {
+    printf("\n]\n");
+  }
+  return TEST_RESULT();
+}
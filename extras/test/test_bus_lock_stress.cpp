@@ -0,0 +1,115 @@
+/*!
+ *  @file test_bus_lock_stress.cpp
+ *
+ * 	Several threads share one driver through a recursive pthread mutex set
+ * with `setBusLock`, while another reads the published snapshot
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+#include <atomic>
+#include <pthread.h>
+
+#define WORKERS 3        ///< Threads using the bus
+#define ITERATIONS 20000 ///< Loops per worker
+
+static Adafruit_EMC2101_Simulator sim;
+static Adafruit_EMC2101 emc;
+static pthread_mutex_t bus_mutex;
+static std::atomic<bool> workers_done(false);
+static std::atomic<uint32_t> failures(0);
+static uint32_t published_reads = 0;
+static uint32_t torn = 0;
+
+static void lock(void *mutex) { pthread_mutex_lock((pthread_mutex_t *)mutex); }
+
+static void unlock(void *mutex) {
+  pthread_mutex_unlock((pthread_mutex_t *)mutex);
+}
+
+static void *worker(void *arg) {
+  uint8_t id = (uint8_t)(uintptr_t)arg;
+  emc2101_snapshot_t snapshot;
+  for (uint32_t i = 0; i < ITERATIONS; i++) {
+    bool ok = true;
+    switch ((i + id) % 4) {
+    case 0:
+      ok = emc.readSnapshot(&snapshot);
+      break;
+    case 1:
+      ok = emc.getExternalTemperatureRaw() != EMC2101_TEMP_RAW_ERROR;
+      break;
+    case 2:
+      ok = emc.setDutyCycleRaw((i >> 2) & MAX_LUT_SPEED);
+      break;
+    default:
+      uint16_t tach;
+      ok = emc.getFanTachRaw(&tach);
+    }
+    if (!ok) {
+      failures++;
+    }
+  }
+  return NULL;
+}
+
+static void *reader(void *) {
+  emc2101_snapshot_t snapshot;
+  while (!workers_done) {
+    if (!emc.getPublishedSnapshot(&snapshot)) {
+      continue;
+    }
+    published_reads++;
+    // every field is derived from the same registers, so a copy that mixed
+    // two snapshots shows up as a mismatch
+    if ((snapshot.fan_rpm != emc2101_tach_to_rpm(snapshot.tach_raw)) ||
+        (snapshot.duty_cycle !=
+         emc2101_duty_raw_to_percent(snapshot.duty_raw)) ||
+        (snapshot.external_temp != snapshot.external_temp_raw * 0.125f)) {
+      torn++;
+    }
+  }
+  return NULL;
+}
+
+int main(void) {
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&bus_mutex, &attr);
+
+  CHECK(emc.begin(&sim));
+  emc.setBusLock(lock, unlock, &bus_mutex);
+  sim.setNoise(2); // keep the temperature changing
+  sim.setExternalTemperature(40);
+  CHECK(emc.setDutyCycle(100));
+
+  uint32_t start_ms = millis();
+  pthread_t workers[WORKERS], reader_thread;
+  pthread_create(&reader_thread, NULL, reader, NULL);
+  for (uintptr_t i = 0; i < WORKERS; i++) {
+    pthread_create(&workers[i], NULL, worker, (void *)i);
+  }
+  for (uint8_t i = 0; i < WORKERS; i++) {
+    pthread_join(workers[i], NULL);
+  }
+  workers_done = true;
+  pthread_join(reader_thread, NULL);
+
+  printf("%u threads x %u calls in %u ms: %u failures, %u interlock "
+         "violations, %u published reads, %u torn\n",
+         WORKERS, ITERATIONS, (unsigned)(millis() - start_ms),
+         (unsigned)failures, (unsigned)sim.interlockViolations(),
+         (unsigned)published_reads, (unsigned)torn);
+  CHECK(failures == 0);
+  CHECK(sim.interlockViolations() == 0);
+  CHECK(emc.lastError() == EMC2101_OK);
+  CHECK(torn == 0);
+  return TEST_RESULT();
+}
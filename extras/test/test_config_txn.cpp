@@ -0,0 +1,93 @@
+/*!
+ *  @file test_config_txn.cpp
+ *
+ * 	Checks configuration transactions against the simulated chip and counts
+ * the transfers they save
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_BusCounter.h"
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+
+static void test_begin_transfers(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101_BusCounter bus(&sim);
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&bus));
+  printf("begin on a chip in its power on state: %u transfers\n",
+         (unsigned)bus.transactions());
+  CHECK(bus.transactions() <= 9);
+  CHECK(sim.peek(EMC2101_FAN_CONFIG) == 0x28); // LUT off, 1.4kHz clock
+  CHECK(sim.peek(EMC2101_PWM_FREQ) == 0x1F);
+  CHECK(sim.peek(EMC2101_REG_FAN_SETTING) == MAX_LUT_SPEED);
+
+  // a second begin only writes PWM_FREQ, which is set whole so it is written
+  // without reading it first, the fan setting, whose state begin forgets, and
+  // the data rate
+  bus.reset();
+  CHECK(emc.begin(&bus));
+  CHECK(bus.writes() == 3);
+}
+
+static void test_staging(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101_BusCounter bus(&sim);
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&bus));
+
+  bus.reset();
+  emc.beginConfig();
+  CHECK(emc.invertFanSpeed(true));
+  CHECK(emc.configPWMClock(0, 1));
+  CHECK(emc.setPWMDivisor(4));
+  CHECK(emc.getPWMDivisor() == 4); // staged value
+  CHECK(bus.writes() == 0);
+  uint8_t changed;
+  CHECK(emc.commitConfig(&changed));
+  CHECK(changed == (EMC2101_TXN_PWM_DIV | EMC2101_TXN_FAN_CONFIG));
+  CHECK(bus.writes() == 2);
+  CHECK(sim.peek(EMC2101_FAN_CONFIG) == 0x34);
+
+  emc.beginConfig();
+  CHECK(emc.invertFanSpeed(false));
+  emc.cancelConfig();
+  CHECK(sim.peek(EMC2101_FAN_CONFIG) == 0x34);
+}
+
+static void test_immediate_writes_refused(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  const emc2101_lut_entry_t lut[] = {{20, 30}, {40, 100}};
+  CHECK(emc.setLUT(lut, 2));
+  CHECK(emc.LUTEnabled(true));
+  delay(100);
+
+  // the chip would ignore these until the staged disable is committed
+  emc.beginConfig();
+  CHECK(emc.LUTEnabled(false));
+  CHECK(!emc.setDutyCycleRaw(10));
+  CHECK(!emc.setDutyCycle(10));
+  CHECK(!emc.setLUT(0, 25, 40));
+  CHECK(!emc.setLUT(lut, 2));
+  CHECK(!emc.swapLUT(lut, 2));
+  CHECK(emc.commitConfig());
+
+  // the LUT left its own choice in the fan setting register
+  CHECK(emc.setDutyCycleRaw(10));
+  CHECK(sim.peek(EMC2101_REG_FAN_SETTING) == 10);
+}
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  test_begin_transfers();
+  test_staging();
+  test_immediate_writes_refused();
+  return TEST_RESULT();
+}
@@ -0,0 +1,71 @@
+/*!
+ *  @file test_curve.cpp
+ *
+ * 	Checks the look up table compiled from a fan curve never runs the fan
+ * slower than the curve itself
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_Curve.h"
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+
+/**
+ * @brief Check the compiled LUT against the curve at every 1/8 degree step
+ * the LUT can see, with the temperature rising so hysteresis doesn't apply
+ */
+static void check_curve(const emc2101_curve_point_t *points, uint8_t count) {
+  Adafruit_EMC2101 emc;
+  Adafruit_EMC2101_Curve curve(&emc);
+  CHECK(curve.setCurve(points, count));
+  emc2101_lut_entry_t entries[EMC2101_LUT_SIZE];
+  uint8_t entry_count = curve.compileHardwareLUT(entries);
+  CHECK(entry_count > 0 && entry_count <= EMC2101_LUT_SIZE);
+
+  uint16_t slower = 0;
+  for (int16_t temp_raw = 0; temp_raw <= (MAX_LUT_TEMP << 3); temp_raw++) {
+    uint8_t lut_duty = 0;
+    for (uint8_t i = 0; i < entry_count; i++) {
+      if ((entries[i].temp_thresh << 3) <= temp_raw) {
+        lut_duty = emc2101_percent_to_duty_raw(entries[i].fan_pwm);
+      }
+    }
+    if (lut_duty < curve.evaluate(temp_raw)) {
+      slower++;
+    }
+  }
+  printf("curve from %d C: %u entries, %u steps slower than the curve\n",
+         points[0].temp, entry_count, slower);
+  CHECK(slower == 0);
+}
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  const emc2101_curve_point_t warm[] = {{30, 20}, {50, 60}, {70, 100}};
+  const emc2101_curve_point_t cold[] = {{-20, 30}, {10, 40}, {40, 100}};
+  const emc2101_curve_point_t hot[] = {{100, 50}, {127, 100}};
+  const emc2101_curve_point_t narrow[] = {{40, 50}, {43, 80}};
+  check_curve(warm, 3);
+  check_curve(cold, 3);
+  check_curve(hot, 2);
+  check_curve(narrow, 2);
+
+  // on the chip, below the curve's first point
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  Adafruit_EMC2101_Curve curve(&emc);
+  CHECK(emc.begin(&sim));
+  CHECK(curve.setCurve(warm, 3));
+  CHECK(curve.pushHardwareLUT());
+  CHECK(emc.setForcedTemperature(10));
+  CHECK(emc.enableForcedTemperature(true));
+  CHECK(emc.LUTEnabled(true));
+  delay(100);
+  CHECK(emc.getDutyCycleRaw() >= curve.evaluate(10 << 3));
+  return TEST_RESULT();
+}
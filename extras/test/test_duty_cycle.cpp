@@ -0,0 +1,143 @@
+/*!
+ *  @file test_duty_cycle.cpp
+ *
+ * 	Counts the bus transactions of the duty cycle paths
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_BusCounter.h"
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+
+/**
+ * @brief Fails every write of one register
+ */
+class FailingWrite : public Adafruit_EMC2101_Transport {
+public:
+  /**
+   * @brief Construct a new FailingWrite
+   * @param transport Where transfers are passed on
+   * @param reg_addr The register whose writes fail
+   */
+  FailingWrite(Adafruit_EMC2101_Transport *transport, uint8_t reg_addr)
+      : _transport(transport), _reg_addr(reg_addr) {}
+  /**
+   * @brief Read a register
+   * @param reg_addr The register address
+   * @param value Where to store the value
+   * @return true: success false: failure
+   */
+  bool read8(uint8_t reg_addr, uint8_t *value) override {
+    return _transport->read8(reg_addr, value);
+  }
+  /**
+   * @brief Write a register, failing for the chosen one
+   * @param reg_addr The register address
+   * @param value The value to write
+   * @return true: success false: failure
+   */
+  bool write8(uint8_t reg_addr, uint8_t value) override {
+    if (failing && (reg_addr == _reg_addr)) {
+      return false;
+    }
+    if (reg_addr == EMC2101_REG_FAN_SETTING) {
+      fan_setting_writes++;
+    }
+    return _transport->write8(reg_addr, value);
+  }
+  bool failing = false;            ///< Whether writes of the register fail
+  uint32_t fan_setting_writes = 0; ///< Writes passed on to the fan setting
+
+private:
+  Adafruit_EMC2101_Transport *_transport; ///< Where transfers are passed on
+  uint8_t _reg_addr;                      ///< The register whose writes fail
+};
+
+static void test_transactions(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101_BusCounter bus(&sim);
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&bus));
+
+  // LUT state unknown: read FAN_CONFIG, disable the LUT, write the setting,
+  // restore FAN_CONFIG
+  CHECK(emc.LUTEnabled(true));
+  bus.reset();
+  CHECK(emc.setDutyCycleRaw(20));
+  uint32_t slow = bus.transactions();
+
+  // LUT known disabled: one write, none if unchanged
+  CHECK(emc.LUTEnabled(false));
+  bus.reset();
+  CHECK(emc.setDutyCycleRaw(30));
+  uint32_t fast = bus.transactions();
+  bus.reset();
+  CHECK(emc.setDutyCycleRaw(30));
+  uint32_t unchanged = bus.transactions();
+  CHECK(sim.peek(EMC2101_REG_FAN_SETTING) == 30);
+
+  // a batch writes only the last of its updates
+  bus.reset();
+  emc.beginDutyCycleBatch();
+  CHECK(emc.setDutyCycleRaw(31) && emc.setDutyCycleRaw(32));
+  CHECK(emc.setDutyCycleRaw(33));
+  CHECK(emc.endDutyCycleBatch());
+  uint32_t batch = bus.transactions();
+  CHECK(sim.peek(EMC2101_REG_FAN_SETTING) == 33);
+
+  printf("setDutyCycleRaw transactions: LUT unknown %u, known off %u, "
+         "unchanged %u, batch of 3 %u\n",
+         (unsigned)slow, (unsigned)fast, (unsigned)unchanged, (unsigned)batch);
+  CHECK(slow >= 4);
+  CHECK(fast == 1 && bus.writes() == 1);
+  CHECK(unchanged == 0);
+  CHECK(batch == 1);
+}
+
+static void test_rebegin_after_reset(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  CHECK(sim.peek(EMC2101_REG_FAN_SETTING) == MAX_LUT_SPEED);
+
+  // the chip loses power and the application starts it again
+  sim.reset();
+  CHECK(emc.begin(&sim));
+  CHECK(sim.peek(EMC2101_REG_FAN_SETTING) == MAX_LUT_SPEED);
+}
+
+static void test_lut_disable_fails(void) {
+  Adafruit_EMC2101_Simulator sim;
+  FailingWrite bus(&sim, EMC2101_FAN_CONFIG);
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&bus));
+  CHECK(emc.setDutyCycle(50));
+  CHECK(sim.peek(EMC2101_REG_FAN_SETTING) == emc2101_percent_to_duty_raw(50));
+  CHECK(emc.LUTEnabled(true));
+
+  // the LUT would overwrite the setting, so it isn't written at all
+  bus.failing = true;
+  bus.fan_setting_writes = 0;
+  CHECK(!emc.setDutyCycleRaw(20));
+  CHECK(bus.fan_setting_writes == 0);
+  bus.failing = false;
+  CHECK(emc.LUTEnabled());
+
+  // and the failed call isn't remembered as the register's value
+  CHECK(emc.LUTEnabled(false));
+  CHECK(emc.setDutyCycleRaw(20));
+  CHECK(sim.peek(EMC2101_REG_FAN_SETTING) == 20);
+}
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  test_transactions();
+  test_rebegin_after_reset();
+  test_lut_disable_fails();
+  return TEST_RESULT();
+}
@@ -0,0 +1,44 @@
+/*!
+ *  @file test_fan_characterizer.cpp
+ *
+ * 	Characterizes the simulated fan and checks the profile against its model
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_FanCharacterizer.h"
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  Adafruit_EMC2101_FanCharacterizer characterizer(&emc);
+  // turns down to 20% once going, needs 35% to start from a stop
+  const emc2101_sim_fan_t fan = {3000, 20, 35, 400};
+  sim.setFan(&fan);
+  CHECK(emc.begin(&sim));
+
+  emc2101_fan_profile_t profile;
+  CHECK(characterizer.run(&profile, 2000));
+  printf("min %u start %u spin-up time %u (%u ms), min RPM %u\n",
+         profile.min_duty_raw, profile.start_duty_raw, profile.spinup_time,
+         profile.spinup_ms, profile.min_rpm);
+
+  // the lowest settings of at least 20% and 35%
+  CHECK(profile.min_duty_raw == 13);
+  CHECK(profile.start_duty_raw == 23);
+  CHECK(profile.rpm[EMC2101_PROFILE_POINTS - 1] > 2900);
+
+  // the fan needs ~70ms at full drive to get fast enough to keep turning at
+  // 20%, so the 50ms spin-up only turns it while the drive lasts
+  CHECK(profile.spinup_drive == 3);
+  CHECK(profile.spinup_time == 2);
+  CHECK(sim.peek(EMC2101_REG_FAN_SETTING) == 0); // left stopped
+  return TEST_RESULT();
+}
@@ -0,0 +1,87 @@
+/*!
+ *  @file test_field_cost.cpp
+ *
+ * 	Times the register bit field accessors on the host against a transport
+ * that only stores the registers, so the result is the driver's own cost per
+ * call without any bus time
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101.h"
+#include "emc2101_test.h"
+#include <chrono>
+
+#define ITERATIONS 1000000 ///< Calls timed per accessor
+
+/**
+ * @brief A register file with no bus behind it
+ */
+class MemoryTransport : public Adafruit_EMC2101_Transport {
+public:
+  /**
+   * @brief Read a register
+   * @param reg_addr The register address
+   * @param value Where to store the value
+   * @return true: success
+   */
+  bool read8(uint8_t reg_addr, uint8_t *value) override {
+    *value = regs[reg_addr];
+    return true;
+  }
+  /**
+   * @brief Write a register
+   * @param reg_addr The register address
+   * @param value The value to write
+   * @return true: success
+   */
+  bool write8(uint8_t reg_addr, uint8_t value) override {
+    regs[reg_addr] = value;
+    return true;
+  }
+  uint8_t regs[256] = {}; ///< Register contents
+};
+
+static MemoryTransport bus;
+static Adafruit_EMC2101 emc;
+static volatile uint32_t sink; ///< Keeps results from being optimized out
+
+static void time_calls(const char *name, void (*fn)(uint32_t)) {
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < ITERATIONS; i++) {
+    fn(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count() /
+              ITERATIONS;
+  printf("%s,%.1f\n", name, ns);
+}
+
+int main(void) {
+  bus.regs[EMC2101_WHOAMI] = EMC2101_CHIP_ID;
+  CHECK(emc.begin(&bus));
+
+  printf("method,ns_per_call\n");
+  time_calls("getDataRate", [](uint32_t) { sink += emc.getDataRate(); });
+  time_calls("setDataRate", [](uint32_t i) {
+    emc.setDataRate((emc2101_rate_t)(i & 0x7));
+  });
+  time_calls("invertFanSpeed", [](uint32_t i) { emc.invertFanSpeed(i & 1); });
+  time_calls("configPWMClock", [](uint32_t i) {
+    emc.configPWMClock(i & 1, (i >> 1) & 1);
+  });
+  time_calls("configFanSpinup(drive time)", [](uint32_t i) {
+    emc.configFanSpinup(i & 3, (i >> 2) & 7);
+  });
+
+  // the accessors still land on the right bits
+  CHECK(emc.setDataRate(EMC2101_RATE_16_HZ));
+  CHECK(emc.getDataRate() == EMC2101_RATE_16_HZ);
+  CHECK(emc.configFanSpinup(2, 5));
+  CHECK((bus.regs[EMC2101_FAN_SPINUP] & 0x1F) == ((2 << 3) | 5));
+  return TEST_RESULT();
+}
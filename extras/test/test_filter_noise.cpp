@@ -0,0 +1,133 @@
+/*!
+ *  @file test_filter_noise.cpp
+ *
+ * 	Measures noise against latency for each external temperature filter
+ * setting, and for averaging unfiltered readings in software, on the simulated
+ * chip. Noise is the spread of readings at a steady temperature with gaussian
+ * noise added to each conversion. Latency is the time until a reading gets 90%
+ * of the way through a 10 degree step, which the filter_noise example can't
+ * force on real hardware. The numbers follow the simulator's model of the
+ * filter, a first order filter of 1/2 or 1/4 per conversion
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+#include <math.h>
+
+#define SAMPLES 64            ///< Values taken for the noise
+#define SETTLE_CONVERSIONS 32 ///< Conversions before each measurement
+#define NOISE_C 0.5           ///< Noise added to each conversion
+#define STEP_FROM_C 40        ///< Temperature before the step
+#define STEP_TO_C 50          ///< Temperature after the step
+
+static Adafruit_EMC2101_Simulator sim;
+static Adafruit_EMC2101 emc;
+
+/**
+ * @brief Result of measuring one setting
+ */
+typedef struct {
+  float stddev_c;      ///< Standard deviation of the values
+  uint16_t latency_ms; ///< Time for a value to show 90% of the step
+  uint8_t read_errors; ///< Reads that failed
+} filter_result_t;
+
+static uint8_t read_errors;
+
+static float take_value(uint8_t conversions) {
+  int32_t sum = 0;
+  uint8_t readings = 0;
+  for (uint8_t i = 0; i < conversions; i++) {
+    emc.waitForConversion();
+    int16_t raw = emc.getExternalTemperatureRaw();
+    if (raw == EMC2101_TEMP_RAW_ERROR) {
+      read_errors++;
+      continue;
+    }
+    sum += raw;
+    readings++;
+  }
+  return readings ? (sum * 0.125f) / readings : NAN;
+}
+
+static filter_result_t measure(emc2101_filter_t filter, uint8_t conversions) {
+  filter_result_t result;
+  CHECK(emc.setFilter(filter));
+  sim.setExternalTemperature(STEP_FROM_C);
+  sim.setNoise(NOISE_C);
+  read_errors = 0;
+  for (uint8_t i = 0; i < SETTLE_CONVERSIONS; i++) {
+    take_value(1);
+  }
+  float values[SAMPLES], mean = 0, variance = 0;
+  for (uint8_t i = 0; i < SAMPLES; i++) {
+    values[i] = take_value(conversions);
+    mean += values[i];
+  }
+  mean /= SAMPLES;
+  for (uint8_t i = 0; i < SAMPLES; i++) {
+    variance += (values[i] - mean) * (values[i] - mean);
+  }
+  result.stddev_c = sqrtf(variance / SAMPLES);
+
+  // step the temperature without noise, so the threshold is crossed once
+  sim.setNoise(0);
+  for (uint8_t i = 0; i < SETTLE_CONVERSIONS; i++) {
+    take_value(1);
+  }
+  sim.setExternalTemperature(STEP_TO_C);
+  uint32_t start_ms = millis();
+  const float threshold = STEP_FROM_C + 0.9f * (STEP_TO_C - STEP_FROM_C);
+  while (take_value(conversions) < threshold) {
+    if ((millis() - start_ms) > 10000) {
+      break;
+    }
+  }
+  result.latency_ms = millis() - start_ms;
+  result.read_errors = read_errors;
+  return result;
+}
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  CHECK(emc.begin(&sim));
+  CHECK(emc.setDataRate(EMC2101_RATE_16_HZ));
+  CHECK(emc.enableConversionTracking(true));
+  CHECK(emc.syncToConversion(200));
+
+  struct {
+    const char *name;
+    emc2101_filter_t filter;
+    uint8_t conversions;
+  } settings[] = {
+      {"disabled", EMC2101_FILTER_DISABLED, 1},
+      {"software_avg_4", EMC2101_FILTER_DISABLED, 4},
+      {"software_avg_8", EMC2101_FILTER_DISABLED, 8},
+      {"level_1", EMC2101_FILTER_LEVEL_1, 1},
+      {"level_2", EMC2101_FILTER_LEVEL_2, 1},
+  };
+  filter_result_t results[5];
+
+  printf("setting,reads_per_value,stddev_c,latency_ms,read_errors\n");
+  for (uint8_t i = 0; i < 5; i++) {
+    results[i] = measure(settings[i].filter, settings[i].conversions);
+    printf("%s,%u,%.3f,%u,%u\n", settings[i].name,
+           settings[i].conversions * 2, results[i].stddev_c,
+           results[i].latency_ms, results[i].read_errors);
+    CHECK(results[i].read_errors == 0);
+  }
+
+  // each filter level trades latency for noise, without extra reads
+  CHECK(results[3].stddev_c < results[0].stddev_c);
+  CHECK(results[4].stddev_c < results[3].stddev_c);
+  CHECK(results[3].latency_ms > results[0].latency_ms);
+  CHECK(results[4].latency_ms > results[3].latency_ms);
+  CHECK(results[2].stddev_c < results[1].stddev_c);
+  return TEST_RESULT();
+}
@@ -0,0 +1,56 @@
+/*!
+ *  @file test_footprint.cpp
+ *
+ * 	Prints the RAM used by a fleet of drivers and checks that starting and
+ * restarting them, as bus recovery does, never allocates from the heap
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+#include <new>
+#include <stdlib.h>
+
+#define INSTANCES 16 ///< Controllers on one node
+#define RESTARTS 100 ///< Times each one is started again
+
+static uint32_t allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static Adafruit_EMC2101_Simulator sims[INSTANCES];
+static Adafruit_EMC2101 drivers[INSTANCES];
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  printf("sizeof(Adafruit_EMC2101) = %u, %u instances = %u bytes\n",
+         (unsigned)sizeof(Adafruit_EMC2101), INSTANCES,
+         (unsigned)sizeof(drivers));
+
+  for (uint16_t restart = 0; restart < RESTARTS; restart++) {
+    for (uint8_t i = 0; i < INSTANCES; i++) {
+      CHECK(drivers[i].begin(&sims[i]));
+      CHECK(drivers[i].setDutyCycle(50));
+    }
+  }
+  printf("%u begins: %u heap allocations\n", INSTANCES * RESTARTS,
+         (unsigned)allocations);
+  CHECK(allocations == 0);
+  return TEST_RESULT();
+}
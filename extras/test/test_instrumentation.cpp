@@ -0,0 +1,75 @@
+/*!
+ *  @file test_instrumentation.cpp
+ *
+ * 	Checks the call counts, transfer counts and timings recorded when the
+ * driver is built with EMC2101_INSTRUMENTATION=1
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_BusCounter.h"
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+#include <string.h>
+
+static_assert(EMC2101_INSTRUMENTATION, "build with EMC2101_INSTRUMENTATION=1");
+
+/**
+ * @brief Dump the counters as JSON into a string
+ */
+static void dump(char *json, size_t size) {
+  json[0] = '\0';
+  FILE *out = tmpfile();
+  CHECK(out != NULL);
+  if (!out) {
+    return;
+  }
+  emc2101_instrumentation_dump(out, true);
+  rewind(out);
+  size_t length = fread(json, 1, size - 1, out);
+  json[length] = '\0';
+  fclose(out);
+}
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101_BusCounter bus(&sim, 100000);
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&bus));
+  emc2101_instrumentation_reset();
+
+  // each call is two reads of 360 us at 100 kHz on the simulated clock. The
+  // transfers count against the innermost method, the time against both
+  for (int i = 0; i < 3; i++) {
+    emc.getExternalTemperature();
+  }
+  char json[4096];
+  dump(json, sizeof(json));
+  CHECK(strstr(json, "{\"method\":\"getExternalTemperatureRaw\",\"calls\":3,"
+                     "\"transfers\":6,\"bytes\":24,\"avg_us\":720,"
+                     "\"max_us\":720,\"hist\":[0,0,0,0,3,0,0,0]}") != NULL);
+  CHECK(strstr(json, "{\"method\":\"getExternalTemperature\",\"calls\":3,"
+                     "\"transfers\":0,\"bytes\":0,\"avg_us\":720,"
+                     "\"max_us\":720,\"hist\":[0,0,0,0,3,0,0,0]}") != NULL);
+
+  // a failing bus retries, and every attempt counts
+  sim.setFailing(true);
+  emc.getExternalTemperature();
+  sim.setFailing(false);
+  dump(json, sizeof(json));
+  CHECK(strstr(json, "{\"method\":\"getExternalTemperatureRaw\",\"calls\":4,"
+                     "\"transfers\":9,") != NULL);
+
+  // reset zeroes every method, but keeps them listed
+  emc2101_instrumentation_reset();
+  dump(json, sizeof(json));
+  CHECK(strstr(json, "{\"method\":\"getExternalTemperatureRaw\",\"calls\":0,"
+                     "\"transfers\":0,\"bytes\":0,\"avg_us\":0,"
+                     "\"max_us\":0,\"hist\":[0,0,0,0,0,0,0,0]}") != NULL);
+  return TEST_RESULT();
+}
@@ -0,0 +1,128 @@
+/*!
+ *  @file test_rpm_controller.cpp
+ *
+ * 	Runs the closed loop fan speed controller against the simulated fan
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_BusCounter.h"
+#include "Adafruit_EMC2101_RPMController.h"
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+
+static void test_settling(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101_BusCounter bus(&sim, 100000);
+  Adafruit_EMC2101 emc;
+  Adafruit_EMC2101_RPMController pid(&emc);
+  CHECK(emc.begin(&bus));
+  CHECK(emc.setDataRate(EMC2101_RATE_16_HZ));
+  CHECK(emc.configFanSpinup(3, 3)); // 100% for 200ms
+  CHECK(pid.begin(200));
+  pid.setTunings(41, 8, 0);
+  pid.setTarget(1500);
+
+  // settled once the speed stays within 5% of the target for a second
+  uint32_t start_ms = millis(), settled_ms = 0, in_band_since = 0;
+  bus.reset();
+  while ((millis() - start_ms) < 20000) {
+    if (pid.update(millis())) {
+      bool in_band = abs((int32_t)pid.lastRPM() - 1500) <= 75;
+      if (!in_band) {
+        in_band_since = 0;
+      } else if (in_band_since == 0) {
+        in_band_since = millis();
+      } else if ((millis() - in_band_since) >= 1000) {
+        settled_ms = in_band_since - start_ms;
+        break;
+      }
+    }
+    delay(1);
+  }
+  float per_tick = (float)bus.transactions() / pid.tickCount();
+  printf("settled to 1500 RPM in %u ms, %u ticks, %.2f transfers/tick\n",
+         (unsigned)settled_ms, (unsigned)pid.tickCount(), per_tick);
+  CHECK(settled_ms > 0 && settled_ms < 5000);
+  // the two tach reads, and a write only when the setting changes
+  CHECK(per_tick >= 2 && per_tick <= 3);
+  CHECK(sim.interlockViolations() == 0);
+}
+
+static void test_restart(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  Adafruit_EMC2101_RPMController pid(&emc);
+  CHECK(emc.begin(&sim));
+  CHECK(pid.begin());
+  pid.setTunings(41, 8, 41);
+  pid.setTarget(0);
+  pid.update(millis());
+  CHECK(pid.lastRPM() == 0);
+
+  // the application runs the fan itself, then hands it back
+  CHECK(emc.setDutyCycle(100));
+  delay(3000);
+  CHECK(pid.begin());
+  CHECK(pid.lastRPM() > 2900);
+  pid.setTarget(3000);
+  delay(100);
+  pid.update(millis());
+  // no derivative kick from the speed seen before the restart
+  printf("first tick after restart: %u\n", pid.lastDutyCycleRaw());
+  CHECK(pid.lastDutyCycleRaw() >= MAX_LUT_SPEED - 2);
+}
+
+static void test_faults(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  Adafruit_EMC2101_RPMController pid(&emc);
+  CHECK(emc.begin(&sim));
+  CHECK(pid.begin());
+  pid.setTunings(41, 8, 0);
+  pid.setSafeDutyCycleRaw(200); // clamped to full speed
+  pid.setTarget(1500);
+
+  // a failed tick holds the safe setting and leaves the error for the caller
+  sim.setFailing(true);
+  pid.update(millis());
+  CHECK(pid.faultCount() == 1);
+  sim.setFailing(false);
+  delay(100);
+  CHECK(pid.update(millis()));
+  CHECK(pid.faultCount() == 1);
+  CHECK(pid.lastDutyCycleRaw() <= MAX_LUT_SPEED);
+  CHECK(emc.lastError() == EMC2101_ERROR_READ);
+}
+
+static void test_limits(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  Adafruit_EMC2101_RPMController pid(&emc);
+  CHECK(emc.begin(&sim));
+
+  // a data rate that doesn't map to a period would tick on every call
+  CHECK(sim.write8(EMC2101_REG_DATA_RATE, 0x0F));
+  CHECK(!pid.begin());
+  CHECK(emc.setDataRate(EMC2101_RATE_16_HZ));
+  CHECK(pid.begin());
+
+  // the largest gains and error saturate the output instead of overflowing
+  pid.setTunings(32767, 32767, 32767);
+  pid.setTarget(65535);
+  CHECK(pid.update(millis()));
+  CHECK(pid.lastDutyCycleRaw() == MAX_LUT_SPEED);
+}
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  test_settling();
+  test_restart();
+  test_faults();
+  test_limits();
+  return TEST_RESULT();
+}
@@ -0,0 +1,299 @@
+/*!
+ *  @file test_simulator.cpp
+ *
+ * 	Checks the simulated EMC2101 behaves like the chip where the driver relies
+ * on it, and that the driver reads it correctly
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_BusCounter.h"
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+
+static uint8_t fan_setting(Adafruit_EMC2101_Simulator *sim) {
+  uint8_t value = 0;
+  CHECK(sim->read8(EMC2101_REG_FAN_SETTING, &value));
+  return value;
+}
+
+static void test_registers(void) {
+  Adafruit_EMC2101_Simulator sim;
+  uint8_t value = 0;
+  CHECK(sim.read8(EMC2101_WHOAMI, &value) && value == EMC2101_CHIP_ID);
+  CHECK(sim.read8(EMC2101_FAN_SPINUP, &value) && value == 0x3F);
+
+  // read-only registers ignore writes
+  CHECK(sim.write8(EMC2101_WHOAMI, 0x00));
+  CHECK(sim.read8(EMC2101_WHOAMI, &value) && value == EMC2101_CHIP_ID);
+
+  sim.setFailing(true);
+  CHECK(!sim.read8(EMC2101_WHOAMI, &value));
+  CHECK(!sim.write8(EMC2101_REG_FAN_SETTING, 1));
+}
+
+static void test_temperature(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  sim.setExternalTemperature(42.625);
+  sim.setInternalTemperature(31);
+  delay(100);
+  CHECK(emc.getExternalTemperature() == 42.625f);
+  CHECK(emc.getInternalTemperature() == 31);
+  sim.setExternalTemperature(-10.5);
+  delay(100);
+  CHECK(emc.getExternalTemperature() == -10.5f);
+
+  // the driver reads the pairs in order
+  emc.getFanRPM();
+  CHECK(sim.interlockViolations() == 0);
+
+  // reading the MSB twice leaves the first LSB unread
+  uint8_t value;
+  sim.read8(EMC2101_EXTERNAL_TEMP_MSB, &value);
+  sim.read8(EMC2101_EXTERNAL_TEMP_MSB, &value);
+  sim.read8(EMC2101_EXTERNAL_TEMP_LSB, &value);
+  CHECK(sim.interlockViolations() == 1);
+  sim.read8(EMC2101_TACH_MSB, &value);
+  CHECK(sim.interlockViolations() == 2);
+}
+
+static void test_conversion_rate(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  CHECK(emc.setDataRate(EMC2101_RATE_4_HZ));
+  uint32_t start = sim.conversionCount();
+  delay(2000);
+  uint32_t conversions = sim.conversionCount() - start;
+  printf("conversions in 2 s at 4 Hz: %u\n", (unsigned)conversions);
+  CHECK(conversions >= 7 && conversions <= 9);
+
+  // the digital filter lags a step
+  CHECK(emc.setFilter(EMC2101_FILTER_LEVEL_2));
+  sim.setExternalTemperature(60);
+  delay(300);
+  float filtered = emc.getExternalTemperature();
+  CHECK(filtered > 25 && filtered < 60);
+  delay(5000);
+  CHECK(emc.getExternalTemperature() > 59.5f);
+}
+
+static void test_fan(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  CHECK(emc.setDutyCycle(100));
+  delay(3000);
+  uint16_t rpm = emc.getFanRPM();
+  printf("full speed: %u RPM\n", rpm);
+  CHECK(rpm > 2900 && rpm < 3100);
+
+  // a turning fan keeps going below its start drive
+  CHECK(emc.setDutyCycle(25));
+  delay(3000);
+  CHECK(sim.fanRPM() > 600);
+  CHECK(emc.setDutyCycle(10));
+  delay(3000);
+  CHECK(emc.getFanRPM() == 0);
+
+  // but doesn't start at it without spin-up
+  CHECK(emc.configFanSpinup(false) && emc.configFanSpinup(0, 0));
+  CHECK(emc.setDutyCycle(0));
+  CHECK(emc.setDutyCycle(25));
+  delay(3000);
+  CHECK(emc.getFanRPM() == 0);
+  CHECK(emc.setDutyCycle(0));
+  CHECK(emc.configFanSpinup(3, 5)); // 100% for 800ms
+  CHECK(emc.setDutyCycle(25));
+  delay(10);
+  CHECK(sim.fanDrivePercent() == 100);
+  delay(3000);
+  CHECK(sim.fanDrivePercent() == fan_setting(&sim) * 100 / MAX_LUT_SPEED);
+  CHECK(emc.getFanRPM() > 600);
+}
+
+static void test_lut(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  const emc2101_lut_entry_t lut[] = {{30, 20}, {50, 60}, {70, 100}};
+  CHECK(emc.setLUT(lut, 3));
+  CHECK(emc.setLUTHysteresis(5));
+  CHECK(emc.LUTEnabled(true));
+  sim.setExternalTemperature(55);
+  delay(100);
+  CHECK(fan_setting(&sim) == sim.peek(EMC2101_LUT_START + 3));
+
+  // falling within the hysteresis keeps the entry
+  sim.setExternalTemperature(47);
+  delay(100);
+  CHECK(fan_setting(&sim) == sim.peek(EMC2101_LUT_START + 3));
+  sim.setExternalTemperature(44);
+  delay(100);
+  CHECK(fan_setting(&sim) == sim.peek(EMC2101_LUT_START + 1));
+  sim.setExternalTemperature(10);
+  delay(100);
+  CHECK(fan_setting(&sim) == 0);
+
+  // the forced temperature overrides the diode
+  CHECK(emc.setForcedTemperature(80));
+  CHECK(emc.enableForcedTemperature(true));
+  delay(100);
+  CHECK(fan_setting(&sim) == MAX_LUT_SPEED);
+
+  // writes to the fan setting are ignored while the LUT runs
+  CHECK(sim.write8(EMC2101_REG_FAN_SETTING, 5));
+  CHECK(fan_setting(&sim) == MAX_LUT_SPEED);
+}
+
+static void test_status(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  CHECK(emc.setExternalTempHighLimit(40));
+  sim.setExternalTemperature(45);
+  delay(100);
+  sim.setExternalTemperature(30);
+  delay(100);
+  // the bit stays latched after the cause has gone, until read
+  CHECK(emc.getStatus() & EMC2101_STATUS_EXT_HIGH);
+  CHECK(!(emc.getStatus() & EMC2101_STATUS_EXT_HIGH));
+
+  // syncToConversion reads the register too, but doesn't lose the bit
+  sim.setExternalTemperature(45);
+  delay(100);
+  sim.setExternalTemperature(30);
+  delay(100);
+  CHECK(emc.syncToConversion(500));
+  CHECK(emc.serviceAlert() & EMC2101_STATUS_EXT_HIGH);
+  CHECK(!(emc.getStatus() & EMC2101_STATUS_EXT_HIGH));
+}
+
+static void test_conversion_tracking(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101_BusCounter bus(&sim, 100000);
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&bus));
+  CHECK(emc.setDataRate(EMC2101_RATE_16_HZ));
+  CHECK(emc.enableConversionTracking(true));
+  CHECK(emc.syncToConversion(500));
+
+  // polling at 200 Hz reads the chip about once per conversion
+  bus.reset();
+  for (int i = 0; i < 200; i++) {
+    emc.getExternalTemperature();
+    delay(5);
+  }
+  printf("external temperature reads in 1 s at 16 Hz: %u, %u cached\n",
+         (unsigned)(bus.reads() / 2), (unsigned)emc.staleReadCount());
+  CHECK(bus.reads() / 2 >= 15 && bus.reads() / 2 <= 18);
+  CHECK(emc.staleReadCount() >= 182);
+
+  // restoring a blob's data rate moves the expected conversions with it
+  uint8_t config[EMC2101_CONFIG_SIZE];
+  CHECK(emc.saveConfig(config));
+  CHECK(emc.setDataRate(EMC2101_RATE_1_HZ));
+  CHECK(emc.syncToConversion(3000));
+  delay(10);
+  CHECK(emc.msUntilNextConversion() > 900);
+  CHECK(emc.restoreConfig(config));
+  CHECK(emc.getDataRate() == EMC2101_RATE_16_HZ);
+  CHECK(emc.msUntilNextConversion() <= 63);
+}
+
+static_assert(emc2101_rpm_to_tach(0) == 0xFFFF, "stopped");
+static_assert(emc2101_rpm_to_tach(82) == 0xFFFF, "too slow to count");
+static_assert(emc2101_rpm_to_tach(83) == 65060, "slowest countable speed");
+static_assert(emc2101_tach_to_rpm(emc2101_rpm_to_tach(3000)) == 3000,
+              "round trip");
+
+static void test_fan_min_rpm(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  CHECK(emc.setFanMinRPM(600));
+  CHECK(emc.getFanMinRPM() == 600);
+  // too slow to count, so the limit is the largest tach count
+  CHECK(emc.setFanMinRPM(50));
+  CHECK(sim.peek(EMC2101_TACH_LIMIT_LSB) == 0xFF);
+  CHECK(sim.peek(EMC2101_TACH_LIMIT_MSB) == 0xFF);
+}
+
+static Adafruit_EMC2101_Simulator *stuck_sim; ///< Freed by `unstick_bus`
+
+static void unstick_bus(void) { stuck_sim->setFailing(false); }
+
+static void test_bus_errors(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  emc.resetBusStats();
+  sim.setFailing(true);
+  CHECK(isnan(emc.getExternalTemperature()));
+  CHECK(emc.lastError() == EMC2101_ERROR_READ);
+  emc2101_bus_stats_t stats;
+  emc.getBusStats(&stats);
+  CHECK(stats.errors == 1 && stats.retries == 2 && stats.recoveries == 0);
+
+  // the error stays until cleared, and recovery runs before the last retry
+  stuck_sim = &sim;
+  emc.setBusRecovery(unstick_bus);
+  CHECK(!isnan(emc.getExternalTemperature()));
+  CHECK(emc.lastError() == EMC2101_ERROR_READ);
+  emc.clearError();
+  CHECK(emc.lastError() == EMC2101_OK);
+  emc.getBusStats(&stats);
+  CHECK(stats.errors == 1 && stats.retries == 4 && stats.recoveries == 1);
+}
+
+static void test_retry_backoff(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+
+  // the doubling delay stops at the largest one instead of wrapping to 0
+  emc.setRetries(4, 0x4000);
+  sim.setFailing(true);
+  uint32_t start = micros();
+  CHECK(isnan(emc.getExternalTemperature()));
+  uint32_t elapsed_us = micros() - start;
+  printf("4 retries from 16384us: %u us\n", (unsigned)elapsed_us);
+  CHECK(elapsed_us == 0x4000 + 0x8000 + 0xFFFF + 0xFFFF);
+}
+
+static void test_bus_counter(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101_BusCounter bus(&sim, 100000);
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&bus));
+  bus.reset();
+  uint32_t start = micros();
+  emc.getExternalTemperature();
+  CHECK(bus.reads() == 2 && bus.writes() == 0);
+  CHECK(bus.bytes() == 2 * EMC2101_BUS_READ_BYTES);
+  CHECK(bus.busMicros() == 720);
+  CHECK((micros() - start) >= 720);
+  CHECK(Adafruit_EMC2101_BusCounter::busMicros(3, 400000) == 68);
+}
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  test_registers();
+  test_temperature();
+  test_conversion_rate();
+  test_fan();
+  test_lut();
+  test_status();
+  test_conversion_tracking();
+  test_fan_min_rpm();
+  test_bus_errors();
+  test_retry_backoff();
+  test_bus_counter();
+  return TEST_RESULT();
+}
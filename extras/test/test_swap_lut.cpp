@@ -0,0 +1,104 @@
+/*!
+ *  @file test_swap_lut.cpp
+ *
+ * 	Counts the transfers of a LUT swap and of its rollback on the simulated
+ * chip, and checks a swap can't spin on the bus when the data rate can't be
+ * read
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_BusCounter.h"
+#include "Adafruit_EMC2101_Simulator.h"
+#include "emc2101_test.h"
+
+/**
+ * @brief Fails every read of one register
+ */
+class FailingRegister : public Adafruit_EMC2101_Transport {
+public:
+  /**
+   * @brief Construct a new FailingRegister
+   * @param transport Where transfers are passed on
+   * @param reg_addr The register whose reads fail
+   */
+  FailingRegister(Adafruit_EMC2101_Transport *transport, uint8_t reg_addr)
+      : _transport(transport), _reg_addr(reg_addr) {}
+  /**
+   * @brief Read a register, failing for the chosen one
+   * @param reg_addr The register address
+   * @param value Where to store the value
+   * @return true: success false: failure
+   */
+  bool read8(uint8_t reg_addr, uint8_t *value) override {
+    if (failing && (reg_addr == _reg_addr)) {
+      return false;
+    }
+    return _transport->read8(reg_addr, value);
+  }
+  /**
+   * @brief Write a register
+   * @param reg_addr The register address
+   * @param value The value to write
+   * @return true: success false: failure
+   */
+  bool write8(uint8_t reg_addr, uint8_t value) override {
+    return _transport->write8(reg_addr, value);
+  }
+  bool failing = false; ///< Whether reads of the register fail
+
+private:
+  Adafruit_EMC2101_Transport *_transport; ///< Where transfers are passed on
+  uint8_t _reg_addr;                      ///< The register whose reads fail
+};
+
+static const emc2101_lut_entry_t quiet[] = {
+    {30, 0}, {45, 30}, {60, 60}, {70, 100}};
+static const emc2101_lut_entry_t burst[] = {{25, 40}, {35, 70}, {45, 100}};
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  Adafruit_EMC2101_Simulator sim;
+  FailingRegister failing(&sim, EMC2101_REG_DATA_RATE);
+  Adafruit_EMC2101_BusCounter bus(&failing, 400000);
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&bus));
+  CHECK(emc.setDataRate(EMC2101_RATE_16_HZ));
+  CHECK(emc.setLUT(quiet, 4));
+  CHECK(emc.LUTEnabled(true));
+
+  bus.reset();
+  uint32_t start_ms = millis();
+  CHECK(emc.swapLUT(burst, 3));
+  uint32_t swap_ms = millis() - start_ms, swap_transfers = bus.transactions();
+  printf("swap: %u transfers in %u ms\n", (unsigned)swap_transfers,
+         (unsigned)swap_ms);
+  CHECK(emc.LUTEnabled());
+  CHECK(sim.peek(EMC2101_LUT_START + 1) == emc2101_percent_to_duty_raw(40));
+
+  // a check that can't pass in time rolls back to the previous table
+  bus.reset();
+  start_ms = millis();
+  CHECK(!emc.swapLUT(quiet, 4, MAX_LUT_SPEED, 0));
+  uint32_t rollback_transfers = bus.transactions();
+  printf("failed swap: %u transfers in %u ms\n", (unsigned)rollback_transfers,
+         (unsigned)(millis() - start_ms));
+  CHECK(emc.LUTEnabled());
+  CHECK(sim.peek(EMC2101_LUT_START + 1) == emc2101_percent_to_duty_raw(40));
+  CHECK(swap_transfers <= 70);
+  CHECK(rollback_transfers <= 70);
+
+  // without the data rate, the checks poll at the fastest conversion rate
+  failing.failing = true;
+  bus.reset();
+  start_ms = millis();
+  CHECK(emc.swapLUT(quiet, 4));
+  printf("swap without the data rate: %u transfers in %u ms\n",
+         (unsigned)bus.transactions(), (unsigned)(millis() - start_ms));
+  CHECK(bus.transactions() <= swap_transfers + 10);
+  return TEST_RESULT();
+}
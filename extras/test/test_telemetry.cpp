@@ -0,0 +1,155 @@
+/*!
+ *  @file test_telemetry.cpp
+ *
+ * 	Checks the telemetry ring buffer keeps its readings in order across the
+ * wrap, counts the ones it drops, samples once per conversion and summarizes
+ * correctly
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_EMC2101_Simulator.h"
+#include "Adafruit_EMC2101_Telemetry.h"
+#include "emc2101_test.h"
+
+static emc2101_sample_t make_sample(uint32_t timestamp_ms, int16_t temp_raw,
+                                    uint16_t rpm, uint8_t status) {
+  emc2101_sample_t sample;
+  sample.timestamp_ms = timestamp_ms;
+  sample.external_temp_raw = temp_raw;
+  sample.fan_rpm = rpm;
+  sample.internal_temp = temp_raw / 8;
+  sample.duty_raw = rpm / 100;
+  sample.status = status;
+  return sample;
+}
+
+static void test_wraparound(void) {
+  Adafruit_EMC2101_Telemetry<4> telemetry(NULL);
+  emc2101_sample_t sample;
+  CHECK(telemetry.available() == 0);
+  CHECK(!telemetry.pop(&sample));
+
+  // the indices wrap many times, and the readings come out in order
+  uint32_t pushed = 0, popped = 0;
+  for (int round = 0; round < 20; round++) {
+    for (int i = 0; i < 2; i++) {
+      sample = make_sample(pushed++, 0, 0, 0);
+      CHECK(telemetry.push(&sample));
+    }
+    CHECK(telemetry.available() == 2);
+    while (telemetry.pop(&sample)) {
+      CHECK(sample.timestamp_ms == popped++);
+    }
+    CHECK(telemetry.available() == 0);
+  }
+  CHECK(popped == 40);
+  CHECK(telemetry.overruns() == 0);
+}
+
+static void test_overruns(void) {
+  Adafruit_EMC2101_Telemetry<4> telemetry(NULL);
+  emc2101_sample_t sample;
+
+  // one slot is kept empty, so a full buffer holds 3 and drops the rest
+  for (uint32_t i = 0; i < 5; i++) {
+    sample = make_sample(i, 0, 0, 0);
+    CHECK(telemetry.push(&sample) == (i < 3));
+  }
+  CHECK(telemetry.available() == 3);
+  CHECK(telemetry.overruns() == 2);
+
+  // the oldest readings are kept, and freeing a slot makes room again
+  CHECK(telemetry.pop(&sample) && sample.timestamp_ms == 0);
+  sample = make_sample(5, 0, 0, 0);
+  CHECK(telemetry.push(&sample));
+  CHECK(telemetry.overruns() == 2);
+  CHECK(telemetry.pop(&sample) && sample.timestamp_ms == 1);
+  CHECK(telemetry.pop(&sample) && sample.timestamp_ms == 2);
+  CHECK(telemetry.pop(&sample) && sample.timestamp_ms == 5);
+  CHECK(telemetry.available() == 0);
+}
+
+static void test_decimation(void) {
+  Adafruit_EMC2101_Simulator sim;
+  Adafruit_EMC2101 emc;
+  CHECK(emc.begin(&sim));
+  CHECK(emc.setDataRate(EMC2101_RATE_16_HZ));
+  Adafruit_EMC2101_Telemetry<32> telemetry(&emc);
+  telemetry.begin();
+
+  // calling every millisecond stores one reading per conversion
+  const uint16_t period_ms = emc2101_rate_period_ms(EMC2101_RATE_16_HZ);
+  uint32_t start = millis();
+  uint8_t stored = 0;
+  for (int i = 0; i < 1000; i++) {
+    if (telemetry.sample(millis())) {
+      stored++;
+    }
+    delay(1);
+  }
+  printf("readings stored in 1 s at 16 Hz: %u\n", stored);
+  CHECK(stored == 1000 / period_ms + 1);
+  CHECK(telemetry.available() == stored);
+
+  emc2101_sample_t sample;
+  uint32_t last_ms = start;
+  CHECK(telemetry.pop(&sample) && sample.timestamp_ms == start);
+  while (telemetry.pop(&sample)) {
+    CHECK(sample.timestamp_ms - last_ms == period_ms);
+    last_ms = sample.timestamp_ms;
+  }
+
+  // a late call takes one reading, not the ones it missed
+  delay(500);
+  CHECK(telemetry.sample(millis()));
+  CHECK(!telemetry.sample(millis()));
+  CHECK(telemetry.available() == 1);
+}
+
+static void test_summarize(void) {
+  Adafruit_EMC2101_Telemetry<8> telemetry(NULL);
+  emc2101_summary_t summary;
+  CHECK(!telemetry.summarize(4, &summary));
+
+  const int16_t temps[] = {-80, 200, 120, 400, 360};
+  const uint16_t rpms[] = {1000, 3000, 2000, 0, 1500};
+  for (uint8_t i = 0; i < 5; i++) {
+    emc2101_sample_t sample =
+        make_sample(100 * i, temps[i], rpms[i], (i == 1) ? 0x10 : 0x02);
+    CHECK(telemetry.push(&sample));
+  }
+
+  CHECK(telemetry.summarize(4, &summary));
+  CHECK(summary.count == 4);
+  CHECK(summary.first_ms == 0 && summary.last_ms == 300);
+  CHECK(summary.external_temp_min == -80 && summary.external_temp_max == 400);
+  CHECK(summary.external_temp_mean == 160);
+  CHECK(summary.internal_temp_min == -10 && summary.internal_temp_max == 50);
+  CHECK(summary.internal_temp_mean == 20);
+  CHECK(summary.fan_rpm_min == 0 && summary.fan_rpm_max == 3000);
+  CHECK(summary.fan_rpm_mean == 1500);
+  CHECK(summary.duty_raw_min == 0 && summary.duty_raw_max == 30);
+  CHECK(summary.duty_raw_mean == 15);
+  CHECK(summary.status == 0x12);
+
+  // the rest is summarized next time
+  CHECK(telemetry.summarize(4, &summary));
+  CHECK(summary.count == 1 && summary.first_ms == 400);
+  CHECK(summary.external_temp_mean == 360 && summary.fan_rpm_mean == 1500);
+  CHECK(summary.status == 0x02);
+  CHECK(telemetry.available() == 0);
+}
+
+int main(void) {
+  emc2101_host_clock()->simulated = true;
+  test_wraparound();
+  test_overruns();
+  test_decimation();
+  test_summarize();
+  return TEST_RESULT();
+}